@@ -0,0 +1,301 @@
+// Microbenchmarks for the scan pipeline at 50, 500 and 5000 networks:
+// reading scan results through the HAL, merging a sweep into the BSS table,
+// publishing the snapshot, sorting by each key (from scratch and after a
+// sweep), serializing /scan as JSON and /live as binary, and escaping SSIDs.
+// Reports ns per op and per network, bytes allocated per op and the peak of
+// live heap, all allocations going through psram.h. The table holds at most
+// BSS_TABLE_MAX networks, so the largest size also measures eviction.
+//
+// Host, from the repo root (after python3 tools/embed_web.py):
+//   g++ -O2 -std=gnu++17 -pthread -Isrc bench/bench_core.cpp $(ls src/*.cpp | grep -v main.cpp) src/native/hal.cpp src/native/psram.cpp -o bench_core
+// Device: pio run -e bench -t upload -t monitor
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "analyzer.h"
+#include "hal.h"
+#include "json_escape.h"
+#include "live_feed.h"
+#include "psram.h"
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <WiFi.h>
+#else
+#include "native/native_hal.h"
+#endif
+
+#define CHANNEL_COUNT 13
+#define SWEEP_VARIANTS 2
+#ifdef ARDUINO
+#define BENCH_MIN_US 200000
+#else
+#define BENCH_MIN_US 300000
+#endif
+#define BENCH_MAX_ITERATIONS (1 << 20)
+// Caps a batch whose untimed setup dwarfs the op being measured
+#define BENCH_MAX_WALL_US (4 * BENCH_MIN_US)
+#ifdef ARDUINO
+#define BENCH_PRINTF Serial.printf
+#else
+#define BENCH_PRINTF printf
+#endif
+
+static const int sizes[] = { 50, 500, 5000 };
+static const char* const sortNames[SORT_KEYS] = { "rssi", "channel", "ssid", "last_seen" };
+static const uint8_t channelWeights[CHANNEL_COUNT] = { 25, 2, 2, 2, 2, 30, 2, 2, 2, 2, 25, 2, 2 };
+
+// Same kind of mix the escaper sees in the field: mostly plain ASCII, some
+// quotes, backslashes, control characters and UTF-8
+static const char* const ssidPatterns[] = {
+  "HomeNet-%04X",
+  "FRITZ!Box 7590 %02X",
+  "Office %u",
+  "Caf\xc3\xa9 \"Latte\" #%u",
+  "Guest\\Wing %u",
+  "Tab\there %u",
+  "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e-%u",
+  "A rather long network name %u with padding",
+};
+
+static volatile size_t sink;
+
+// One sweep's results grouped by channel
+struct Sweep {
+  std::vector<ScanResult> channel[CHANNEL_COUNT];
+};
+
+static uint32_t hash32(uint32_t x) {
+  x ^= x >> 16;
+  x *= 0x7feb352d;
+  x ^= x >> 15;
+  x *= 0x846ca68b;
+  x ^= x >> 16;
+  return x;
+}
+
+// Network `i` is the same at every size, so larger sizes only add networks
+static void makeNetwork(uint32_t i, uint32_t variant, ScanResult& r) {
+  uint32_t h = hash32(i + 1);
+  const uint8_t bssid[6] = { 0x02, 0x42, 0x00, (uint8_t)(i >> 16), (uint8_t)(i >> 8), (uint8_t)i };
+  memcpy(r.bssid, bssid, sizeof(bssid));
+
+  uint32_t pick = h % 100;
+  r.channel = CHANNEL_COUNT;
+  for(int c = 0; c < CHANNEL_COUNT; c++) {
+    if(pick < channelWeights[c]) {
+      r.channel = c + 1;
+      break;
+    }
+    pick -= channelWeights[c];
+  }
+
+  // Each variant moves RSSI by a few dB, as consecutive sweeps do
+  r.rssi = -40 - (int)(h >> 8) % 50 + (int)(hash32(h + variant) % 7) - 3;
+  r.authmode = (h >> 16) % 7;
+  if((h >> 20) % 20 == 0) {
+    r.ssidLen = 0;
+    return;
+  }
+  char name[64];
+  snprintf(name, sizeof(name), ssidPatterns[(h >> 24) % (sizeof(ssidPatterns) / sizeof(ssidPatterns[0]))], i & 0xffff);
+  r.ssidLen = strnlen(name, sizeof(r.ssid));
+  memcpy(r.ssid, name, r.ssidLen);
+}
+
+static void makeSweep(int networks, uint32_t variant, Sweep& sweep) {
+  for(std::vector<ScanResult>& results : sweep.channel) results.clear();
+  for(int i = 0; i < networks; i++) {
+    ScanResult r;
+    makeNetwork(i, variant, r);
+    sweep.channel[r.channel - 1].push_back(r);
+  }
+}
+
+static void mergeSweep(const Sweep& sweep) {
+  for(const std::vector<ScanResult>& results : sweep.channel) analyzerMerge(results.data(), results.size());
+}
+
+struct Measurement {
+  uint32_t iterations;
+  double nsPerOp;
+  double allocPerOp;
+  size_t peakBytes;
+};
+
+// Runs `op` in doubling batches until a batch takes `minUs`, with `setup`
+// (untimed) before every call, or the whole batch runs too long
+template <typename Setup, typename Op>
+static Measurement measure(Setup setup, Op op, uint64_t minUs = BENCH_MIN_US) {
+  Measurement m;
+  for(uint32_t iterations = 1;; iterations *= 2) {
+    psramResetPeak();
+    PsramStats before = psramStats();
+    uint64_t elapsed = 0;
+    uint64_t batchStart = halMicros();
+    for(uint32_t i = 0; i < iterations; i++) {
+      setup();
+      uint64_t start = halMicros();
+      op();
+      elapsed += halMicros() - start;
+    }
+    PsramStats after = psramStats();
+    bool overlong = halMicros() - batchStart >= BENCH_MAX_WALL_US;
+    if(elapsed >= minUs || overlong || iterations >= BENCH_MAX_ITERATIONS) {
+      m.iterations = iterations;
+      m.nsPerOp = elapsed * 1000.0 / iterations;
+      m.allocPerOp = (double)(after.allocatedBytes - before.allocatedBytes) / iterations;
+      m.peakBytes = after.peakBytes;
+      return m;
+    }
+  }
+}
+
+template <typename Op>
+static Measurement measure(Op op) {
+  return measure([] {}, op);
+}
+
+static void report(const char* stage, uint32_t networks, const Measurement& m) {
+  BENCH_PRINTF("%-18s %6u %12.0f %10.1f %12.0f %10.1f\n", stage, (unsigned)networks, m.nsPerOp,
+         networks ? m.nsPerOp / networks : 0.0, m.allocPerOp, m.peakBytes / 1024.0);
+}
+
+#ifndef ARDUINO
+// Replays the current sweep through the native HAL's scan source
+static const Sweep* replaying = nullptr;
+
+static int replaySource(uint8_t channel, ScanResult* out, int max) {
+  const std::vector<ScanResult>& results = replaying->channel[channel - 1];
+  int count = (int)results.size() < max ? results.size() : max;
+  memcpy(out, results.data(), sizeof(ScanResult) * count);
+  return count;
+}
+#endif
+
+// Reading one sweep's results back through halScanResult(). On the device
+// the radio sets the pace of the scan itself, so only the read-back of one
+// real channel scan is timed there, whatever it found.
+static void benchIngest(const Sweep& sweep, int networks) {
+#ifdef ARDUINO
+  (void)sweep;
+  (void)networks;
+  int found = halScanChannel(6, 120);
+  if(found < 0) found = 0;
+  Measurement m = measure([found] {
+    ScanResult r;
+    for(int i = 0; i < found; i++) sink += halScanResult(i, r);
+  });
+  report("ingest (ch 6)", found, m);
+#else
+  replaying = &sweep;
+  Measurement m = measure([] {
+    ScanResult r;
+    for(uint8_t c = 1; c <= CHANNEL_COUNT; c++) {
+      int found = halScanChannel(c, 0);
+      for(int i = 0; i < found; i++) sink += halScanResult(i, r);
+      halScanRelease();
+    }
+  });
+  report("ingest", networks, m);
+#endif
+}
+
+static void benchSize(int networks) {
+  Sweep sweeps[SWEEP_VARIANTS];
+  for(uint32_t v = 0; v < SWEEP_VARIANTS; v++) makeSweep(networks, v, sweeps[v]);
+  uint32_t variant = 0;
+
+  benchIngest(sweeps[0], networks);
+
+  // The first sweep at a size inserts whatever the smaller sizes did not;
+  // it only happens once
+  Measurement m = measure([] {}, [&] { mergeSweep(sweeps[0]); }, 0);
+  report("merge new", networks, m);
+
+  m = measure([&] { mergeSweep(sweeps[variant++ % SWEEP_VARIANTS]); });
+  uint32_t held = analyzerPublish();
+  report("merge", networks, m);
+
+  m = measure([&] {
+    mergeSweep(sweeps[variant++ % SWEEP_VARIANTS]);
+    held = analyzerPublish();
+  });
+  report("merge+publish", networks, m);
+
+  for(int key = 0; key < SORT_KEYS; key++) {
+    char stage[32];
+    snprintf(stage, sizeof(stage), "sort %s", sortNames[key]);
+    m = measure([key] { analyzerSort(key, true); });
+    report(stage, held, m);
+
+    // Incremental: a new generation after one more sweep. At the largest
+    // size the table is full, so every sweep evicts and moves records and
+    // this falls back to a full sort
+    snprintf(stage, sizeof(stage), "resort %s", sortNames[key]);
+    m = measure([&] {
+      mergeSweep(sweeps[variant++ % SWEEP_VARIANTS]);
+      analyzerPublish();
+    }, [key] { analyzerSort(key, false); });
+    report(stage, held, m);
+  }
+
+  size_t jsonBytes = 0;
+  m = measure([&] { jsonBytes = analyzerRenderScan(); });
+  report("json /scan", held, m);
+
+  // Every network's sample, drained in /live messages
+  static uint8_t frame[LIVE_PAYLOAD_MAX];
+  size_t binaryBytes = 0;
+  liveSetActive(true);
+  m = measure([&] {
+    binaryBytes = 0;
+    for(int i = 0; i < networks; i += LIVE_MAX_RECORDS) {
+      int end = i + LIVE_MAX_RECORDS < networks ? i + LIVE_MAX_RECORDS : networks;
+      for(int j = i; j < end; j++) livePush(j + 1, -60, 6);
+      binaryBytes += liveEncode(frame, halMillis());
+    }
+  });
+  liveSetActive(false);
+  report("binary /live", networks, m);
+
+  static char escaped[32 * JSON_ESCAPE_MAX];
+  const Sweep& sweep = sweeps[0];
+  m = measure([&] {
+    for(const std::vector<ScanResult>& results : sweep.channel) {
+      for(const ScanResult& r : results) sink += jsonEscape((const char*)r.ssid, r.ssidLen, escaped);
+    }
+  });
+  report("escape ssids", networks, m);
+
+  BENCH_PRINTF("  %u held, /scan %u bytes, /live %u bytes\n", (unsigned)held, (unsigned)jsonBytes, (unsigned)binaryBytes);
+}
+
+static void benchMain() {
+#ifndef ARDUINO
+  nativeSetScanSource(replaySource);
+  nativeSetScanDelay(false);
+#endif
+  analyzerCoreBegin();
+  BENCH_PRINTF("%-18s %6s %12s %10s %12s %10s\n", "stage", "nets", "ns/op", "ns/net", "alloc B/op", "peak KB");
+  for(int networks : sizes) benchSize(networks);
+  PsramStats stats = psramStats();
+  BENCH_PRINTF("%u allocations, %.1f KB live at exit\n", (unsigned)stats.allocations, stats.liveBytes / 1024.0);
+}
+
+#ifdef ARDUINO
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  WiFi.mode(WIFI_STA);
+  benchMain();
+}
+
+void loop() {
+  halDelay(1000);
+}
+#else
+int main() {
+  benchMain();
+  return 0;
+}
+#endif
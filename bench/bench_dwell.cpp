@@ -0,0 +1,240 @@
+// Replays sweeps through DwellPlanner with the analyzer's settings and
+// checks that the shorter sweeps do not cost detections. A scan of a
+// channel hears each AP on the air there with probability
+// min(1, dwell / beacon interval), so a short dwell can miss it; what the
+// scan heard is what the planner is fed, as on the device. Probe responses
+// to the active scan are ignored, which makes the model pessimistic. Every
+// environment is replayed twice, with the planner and with the fixed 300 ms
+// per channel it replaced, and both report dwell per sweep, the share of
+// audible APs a sweep missed and the longest time an AP on the air went
+// unheard. Exits non-zero if the planner misses more than MISS_BUDGET_PCT
+// of them or leaves one unheard for longer than GAP_BUDGET_MS, half the
+// analyzer's BSS TTL, so misses alone never expire a network.
+//
+// Environments come from src/native/rf_sim.h, or from a trace file of
+// "<channel> <apCount>" lines in scan order ('#' starts a comment), each
+// count taken as the APs on the air with the common 100 TU interval. Only
+// dwell is counted; the scanner's gaps between ticks come on top.
+//
+// Host, from the repo root:
+//   g++ -O2 -std=gnu++17 -pthread -Isrc bench/bench_dwell.cpp src/dwell_planner.cpp src/ie_parser.cpp src/native/hal.cpp src/native/rf_sim.cpp -o bench_dwell
+//   ./bench_dwell [trace.txt]
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+#include "dwell_planner.h"
+#include "native/rf_sim.h"
+
+// Keep in step with src/analyzer.cpp
+#define SWEEP_BUDGET_MS 1600
+#define MIN_DWELL_MS 20
+#define MAX_DWELL_MS 250
+#define BUSY_DWELL_MS 110
+#define FIXED_DWELL_MS 300
+
+#define SWEEPS 60
+#define SETTLE_SWEEPS 10
+#define SCAN_MAX 256
+#define BEACON_INTERVAL_MS 102
+#define MISS_BUDGET_PCT 10
+#define GAP_BUDGET_MS 30000
+
+struct Scenario {
+  const char* name;
+  int apCount;
+  float areaMeters;
+  bool allChannels;
+};
+
+static const Scenario scenarios[] = {
+  { "office, mostly 1/6/11", 60, 120, false },
+  { "apartment block", 200, 150, false },
+  { "sparse, all channels", 12, 200, true },
+  { "dense, all channels", 600, 150, true },
+};
+
+// Most APs beacon every 100 TU; one in eight uses 200 TU and one in
+// sixteen 300 TU, picked by BSSID so both replays agree
+static uint32_t beaconInterval(const uint8_t* bssid) {
+  uint32_t h = bssid[3] * 131u + bssid[4] * 31u + bssid[5];
+  h ^= h >> 5;
+  if(h % 16 == 0) return 3 * BEACON_INTERVAL_MS;
+  if(h % 8 == 1) return 2 * BEACON_INTERVAL_MS;
+  return BEACON_INTERVAL_MS;
+}
+
+static uint64_t bssidKey(const uint8_t* bssid) {
+  uint64_t key = 0;
+  for(int i = 0; i < 6; i++) key = key << 8 | bssid[i];
+  return key;
+}
+
+struct Replay {
+  explicit Replay(bool planned) : planned(planned) {}
+
+  bool planned;
+  DwellPlanner planner{ SWEEP_BUDGET_MS, MIN_DWELL_MS, MAX_DWELL_MS, BUSY_DWELL_MS };
+  std::mt19937 rng{ 7 };
+  std::vector<uint32_t> sweepMs;
+  uint32_t current = 0;
+  int scans = 0;
+  uint32_t nowMs = 0;
+
+  // Counted once the planner has settled
+  uint64_t audible = 0;
+  uint64_t missed = 0;
+  uint32_t worstGapMs = 0;
+  // Start of each AP's run of scans that had it on the air but missed it
+  std::unordered_map<uint64_t, uint32_t> missedSince;
+
+  uint16_t dwellFor(uint8_t channel) const {
+    return planned ? planner.dwellFor(channel) : FIXED_DWELL_MS;
+  }
+
+  bool hears(uint32_t dwell, uint32_t interval) {
+    return dwell >= interval || rng() % interval < dwell;
+  }
+
+  // One scan of `channel` with `count` APs on the air; `intervals` gives
+  // each one's beacon interval and `keys` identifies them (may be null)
+  void scan(uint8_t channel, int count, const uint32_t* intervals, const uint64_t* keys) {
+    uint16_t dwell = dwellFor(channel);
+    bool counting = scans >= SETTLE_SWEEPS * DWELL_CHANNELS;
+    int heard = 0;
+    for(int i = 0; i < count; i++) {
+      bool h = hears(dwell, intervals ? intervals[i] : BEACON_INTERVAL_MS);
+      heard += h;
+      if(!counting) continue;
+      audible++;
+      missed += !h;
+      if(!keys) continue;
+      auto it = missedSince.find(keys[i]);
+      if(h) {
+        if(it == missedSince.end()) continue;
+        if(nowMs - it->second > worstGapMs) worstGapMs = nowMs - it->second;
+        missedSince.erase(it);
+      } else if(it == missedSince.end()) {
+        missedSince[keys[i]] = nowMs;
+      }
+    }
+    planner.record(channel, heard);
+
+    nowMs += dwell;
+    current += dwell;
+    if(++scans % DWELL_CHANNELS == 0) {
+      sweepMs.push_back(current);
+      current = 0;
+    }
+  }
+};
+
+static void header() {
+  printf("%-22s %-7s %8s %8s %8s %8s %10s\n", "trace", "dwell", "first", "settled", "max", "missed", "unheard s");
+}
+
+// Returns false if the planner broke the miss budget
+static bool report(const char* name, const Replay& replay) {
+  size_t n = replay.sweepMs.size();
+  if(n == 0) {
+    printf("%-22s no complete sweep\n", name);
+    return true;
+  }
+
+  // The first sweep treats every channel as busy; settled is the mean
+  // after SETTLE_SWEEPS, or over the second half of a short trace
+  size_t from = n > SETTLE_SWEEPS * 2 ? SETTLE_SWEEPS : n / 2;
+  uint64_t sum = 0;
+  uint32_t hi = 0;
+  for(size_t i = from; i < n; i++) {
+    sum += replay.sweepMs[i];
+    if(replay.sweepMs[i] > hi) hi = replay.sweepMs[i];
+  }
+  double missPct = replay.audible ? 100.0 * replay.missed / replay.audible : 0;
+  printf("%-22s %-7s %8u %8u %8u %7.1f%% %10.1f\n", name, replay.planned ? "planned" : "fixed", replay.sweepMs[0],
+         (unsigned)(sum / (n - from)), hi, missPct, replay.worstGapMs / 1000.0);
+
+  if(!replay.planned) return true;
+  bool ok = missPct <= MISS_BUDGET_PCT && replay.worstGapMs <= GAP_BUDGET_MS;
+  printf("%-22s", ok ? "  dwell ms by channel" : "  OVER BUDGET, dwell");
+  for(int c = 1; c <= DWELL_CHANNELS; c++) printf(" %u", replay.planner.dwellFor(c));
+  printf("\n");
+  return ok;
+}
+
+static int replayFile(const char* path) {
+  FILE* f = fopen(path, "r");
+  if(!f) {
+    perror(path);
+    return 1;
+  }
+
+  Replay planned(true), fixed(false);
+  char line[128];
+  int lineNo = 0;
+  while(fgets(line, sizeof(line), f)) {
+    lineNo++;
+    char* hash = strchr(line, '#');
+    if(hash) *hash = 0;
+    int channel, count;
+    int fields = sscanf(line, "%d %d", &channel, &count);
+    if(fields <= 0) continue;
+    if(fields != 2 || channel < 1 || channel > DWELL_CHANNELS || count < 0) {
+      fprintf(stderr, "%s:%d: expected \"<channel 1-%d> <apCount>\"\n", path, lineNo, DWELL_CHANNELS);
+      fclose(f);
+      return 1;
+    }
+    planned.scan(channel, count, nullptr, nullptr);
+    fixed.scan(channel, count, nullptr, nullptr);
+  }
+  fclose(f);
+
+  header();
+  bool ok = report(path, planned);
+  report(path, fixed);
+  return ok ? 0 : 1;
+}
+
+static void replayScenario(const Scenario& s, Replay& replay) {
+  RfSimConfig config;
+  config.apCount = s.apCount;
+  config.areaMeters = s.areaMeters;
+  config.churnPerMinute = 0.05f;
+  if(s.allChannels) {
+    for(float& w : config.channelWeights) w = 1;
+  }
+  RfSim sim(config);
+
+  static ScanResult results[SCAN_MAX];
+  static uint32_t intervals[SCAN_MAX];
+  static uint64_t keys[SCAN_MAX];
+  for(int i = 0; i < SWEEPS * DWELL_CHANNELS; i++) {
+    uint8_t channel = i % DWELL_CHANNELS + 1;
+    sim.advance(replay.nowMs);
+    int count = sim.scan(channel, results, SCAN_MAX);
+    for(int j = 0; j < count; j++) {
+      intervals[j] = beaconInterval(results[j].bssid);
+      keys[j] = bssidKey(results[j].bssid);
+    }
+    replay.scan(channel, count, intervals, keys);
+  }
+}
+
+int main(int argc, char** argv) {
+  if(argc > 1) return replayFile(argv[1]);
+
+  printf("fixed dwell: %u ms per sweep; budget: %d%% missed, %d s unheard\n", FIXED_DWELL_MS * DWELL_CHANNELS,
+         MISS_BUDGET_PCT, GAP_BUDGET_MS / 1000);
+  header();
+  bool ok = true;
+  for(const Scenario& s : scenarios) {
+    Replay planned(true), fixed(false);
+    replayScenario(s, planned);
+    replayScenario(s, fixed);
+    ok &= report(s.name, planned);
+    report(s.name, fixed);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,447 @@
+// Correctness, throughput and robustness of the beacon / IE parser. The
+// corpus is the frames of pcap captures (radiotap or raw 802.11 link type;
+// bench/data/beacons.pcap by default, see tools/make_beacon_pcap.py), the
+// beacons of a synthetic environment (src/native/rf_sim.h) and hand-built
+// frames with every IE the parser reads, an oversized SSID and more vendor
+// IEs than it keeps. The hand-built frames and the default sample must
+// parse to known summaries. Reports frames/sec and MB/s parsing the
+// corpus, then feeds it malformed copies: every truncation, every IE
+// length byte forced short and oversized, and random mutations. Each copy
+// sits in a buffer of exactly its size, and every pointer the parser hands
+// back must stay inside the frame; build with -fsanitize=address,undefined
+// to also catch stray reads. Exits non-zero on any violation.
+//
+// Host, from the repo root:
+//   g++ -O2 -std=gnu++17 -pthread -Isrc bench/bench_ie_parser.cpp src/ie_parser.cpp src/native/hal.cpp src/native/rf_sim.cpp -o bench_ie_parser
+//   ./bench_ie_parser [capture.pcap ...]
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "ie_parser.h"
+#include "native/rf_sim.h"
+
+#define ROUNDS 20
+#define REPEATS 50
+#define MUTATION_CASES 500000
+#define MUTATIONS_MAX 4
+#define FORMAT_BUF 24
+#define SUMMARY_MAX 512
+#define DEFAULT_PCAP "bench/data/beacons.pcap"
+
+#define PCAP_MAGIC_US 0xa1b2c3d4
+#define PCAP_MAGIC_NS 0xa1b23c4d
+#define LINKTYPE_IEEE802_11 105
+#define LINKTYPE_RADIOTAP 127
+#define RADIOTAP_TSFT (1u << 0)
+#define RADIOTAP_FLAGS (1u << 1)
+#define RADIOTAP_EXT (1u << 31)
+#define RADIOTAP_F_FCS 0x10
+
+typedef std::vector<uint8_t> Frame;
+
+// A frame and what parsing it must produce, as summary() writes it
+struct Expected {
+  const char* name;
+  Frame frame;
+  const char* summary;
+};
+
+static std::vector<Frame> corpus;
+static std::vector<Expected> expected;
+static volatile uint32_t sink;
+static uint32_t violations;
+
+static void collect(const uint8_t* frame, uint16_t len, int8_t, uint8_t) {
+  corpus.emplace_back(frame, frame + len);
+}
+
+static void put(Frame& f, uint8_t id, const std::vector<uint8_t>& body) {
+  f.push_back(id);
+  f.push_back((uint8_t)body.size());
+  f.insert(f.end(), body.begin(), body.end());
+}
+
+static Frame header(uint8_t subtype, uint16_t capability) {
+  Frame f(MGMT_HEADER_LEN + BEACON_FIXED_LEN, 0);
+  f[0] = subtype;
+  memset(&f[4], 0xff, 6);
+  for(int i = 0; i < 6; i++) f[10 + i] = f[16 + i] = 0x20 + i;
+  f[MGMT_HEADER_LEN + 8] = 0x64;
+  f[MGMT_HEADER_LEN + 10] = capability & 0xff;
+  f[MGMT_HEADER_LEN + 11] = capability >> 8;
+  return f;
+}
+
+// Frames that reach the branches synthetic beacons do not, each with the
+// summary it must parse to
+static void addHandBuilt() {
+  Frame f = header(MGMT_SUBTYPE_BEACON, 0x0011);
+  put(f, IE_SSID, { 'L', 'a', 'b' });
+  put(f, IE_DS_PARAMS, { 36 });
+  put(f, IE_COUNTRY, { 'D', 'E', 0x20, 36, 4, 23 });
+  put(f, IE_HT_CAPABILITIES, std::vector<uint8_t>(26, 0x6f));
+  put(f, IE_HT_OPERATION, { 36, 0x05, 0, 0, 0, 0 });
+  put(f, IE_VHT_CAPABILITIES, { 0x92, 0x71, 0x80, 0x0f, 0xfa, 0xff, 0, 0, 0xfa, 0xff, 0, 0 });
+  put(f, IE_VHT_OPERATION, { 1, 42, 0, 0xfc, 0xff });
+  put(f, IE_RSN, { 1, 0, 0x00, 0x0f, 0xac, 4, 1, 0, 0x00, 0x0f, 0xac, 4, 1, 0, 0x00, 0x0f, 0xac, 2, 0, 0 });
+  expected.push_back({ "WPA2-PSK, VHT", f, "beacon ssid=\"Lab\" ch=36 cc=DE sec=WPA2 ciphers=CCMP akms=PSK phy=ac vendors=0" });
+
+  f = header(MGMT_SUBTYPE_BEACON, 0x0011);
+  put(f, IE_SSID, { 'S', 'a', 'e' });
+  put(f, IE_DS_PARAMS, { 1 });
+  put(f, IE_HT_CAPABILITIES, std::vector<uint8_t>(26, 0));
+  put(f, IE_EXTENSION, { IE_EXT_HE_CAPABILITIES, 1, 2, 3, 4, 5, 6 });
+  put(f, IE_RSN, { 1, 0, 0x00, 0x0f, 0xac, 4, 1, 0, 0x00, 0x0f, 0xac, 4, 1, 0, 0x00, 0x0f, 0xac, 8, 0xc0, 0 });
+  expected.push_back({ "WPA3-SAE, HE", f, "beacon ssid=\"Sae\" ch=1 cc= sec=WPA3 ciphers=CCMP akms=SAE phy=ax vendors=0" });
+
+  f = header(MGMT_SUBTYPE_BEACON, 0x0011);
+  put(f, IE_SSID, { 'O', 'l', 'd' });
+  put(f, IE_DS_PARAMS, { 11 });
+  put(f, IE_RSN, { 1, 0, 0x00, 0x0f, 0xac, 2, 2, 0, 0x00, 0x0f, 0xac, 4, 0x00, 0x0f, 0xac, 2, 1, 0, 0x00, 0x0f, 0xac, 2 });
+  put(f, IE_VENDOR, { 0x00, 0x50, 0xf2, 1, 1, 0, 0x00, 0x50, 0xf2, 2, 1, 0, 0x00, 0x50, 0xf2, 2, 1, 0, 0x00, 0x50, 0xf2, 2 });
+  expected.push_back({ "WPA/WPA2, CCMP+TKIP", f,
+                       "beacon ssid=\"Old\" ch=11 cc= sec=WPA/WPA2 ciphers=CCMP+TKIP akms=PSK phy=bg vendors=1" });
+
+  f = header(MGMT_SUBTYPE_BEACON, 0x0001);
+  put(f, IE_SSID, { 'C', 'a', 'f', 'e' });
+  put(f, IE_DS_PARAMS, { 6 });
+  expected.push_back({ "open", f, "beacon ssid=\"Cafe\" ch=6 cc= sec=Open ciphers= akms= phy=bg vendors=0" });
+
+  f = header(MGMT_SUBTYPE_BEACON, 0x0011);
+  put(f, IE_SSID, { 'W', 'e', 'p' });
+  put(f, IE_HT_OPERATION, { 3, 0x07 });
+  expected.push_back({ "WEP, channel from HT", f, "beacon ssid=\"Wep\" ch=3 cc= sec=WEP ciphers= akms= phy=bg vendors=0" });
+
+  // Every IE at once, more vendor IEs than are kept and a mixed suite list
+  f = header(MGMT_SUBTYPE_BEACON, 0x0011);
+  put(f, IE_SSID, { 'L', 'a', 'b' });
+  put(f, IE_DS_PARAMS, { 36 });
+  put(f, IE_COUNTRY, { 'D', 'E', 0x20, 1, 13, 20 });
+  put(f, IE_HT_CAPABILITIES, std::vector<uint8_t>(26, 0x6f));
+  put(f, IE_HT_OPERATION, { 36, 0x07, 0, 0, 0, 0 });
+  put(f, IE_VHT_CAPABILITIES, { 0x92, 0x71, 0x80, 0x0f, 0xfa, 0xff, 0, 0, 0xfa, 0xff, 0, 0 });
+  put(f, IE_VHT_OPERATION, { 1, 42, 0, 0xfc, 0xff });
+  put(f, IE_EXTENSION, { IE_EXT_HE_CAPABILITIES, 1, 2, 3, 4, 5, 6 });
+  put(f, IE_RSN, { 1, 0, 0x00, 0x0f, 0xac, 4, 3, 0, 0x00, 0x0f, 0xac, 4, 0x00, 0x0f, 0xac, 2, 0x00, 0x0f, 0xac, 9,
+                   2, 0, 0x00, 0x0f, 0xac, 8, 0x00, 0x0f, 0xac, 2, 0xcc, 0 });
+  put(f, IE_VENDOR, { 0x00, 0x50, 0xf2, 1, 1, 0, 0x00, 0x50, 0xf2, 2, 1, 0, 0x00, 0x50, 0xf2, 2, 1, 0, 0x00, 0x50, 0xf2, 2 });
+  for(int i = 0; i < MAX_VENDOR_IES + 2; i++) put(f, IE_VENDOR, { 0x00, 0x50, 0xf2, 2, (uint8_t)i });
+  expected.push_back({ "every IE", f,
+                       "beacon ssid=\"Lab\" ch=36 cc=DE sec=WPA2/WPA3 ciphers=CCMP+GCMP-256+TKIP akms=PSK+SAE phy=ax vendors=6" });
+
+  // An oversized SSID, which the parser skips, before a hidden one, and
+  // suite counts far larger than the IEs holding them
+  f = header(MGMT_SUBTYPE_PROBE_RESP, 0x0001);
+  put(f, IE_SSID, std::vector<uint8_t>(33, 'x'));
+  put(f, IE_SSID, std::vector<uint8_t>(8, 0));
+  put(f, IE_RSN, { 1, 0, 0x00, 0x0f, 0xac, 4, 0xff, 0xff, 0x00, 0x0f, 0xac, 4 });
+  put(f, IE_VENDOR, { 0x00, 0x50, 0xf2, 1, 1, 0, 0x00, 0x50, 0xf2, 2, 0xff, 0xff });
+  put(f, IE_EXTENSION, {});
+  put(f, 250, std::vector<uint8_t>(255, 0xa5));
+  expected.push_back({ "oversized and hidden SSID", f,
+                       "probe-resp ssid=\"\\x00\\x00\\x00\\x00\\x00\\x00\\x00\\x00\" hidden ch=0 cc= sec=WPA/WPA2 "
+                       "ciphers=CCMP akms= phy=bg vendors=1" });
+
+  for(const Expected& e : expected) corpus.push_back(e.frame);
+}
+
+// What the default sample must parse to, in file order; null for frames the
+// parser must reject
+static const char* const sampleSummaries[] = {
+  "beacon ssid=\"HomeRouter-5A2F\" ch=6 cc=US sec=WPA2 ciphers=CCMP akms=PSK phy=n vendors=2",
+  "beacon ssid=\"Office\" ch=36 cc=DE sec=WPA2/WPA3 ciphers=CCMP akms=PSK+SAE phy=ax vendors=5",
+  "beacon ssid=\"Corp-Secure\" ch=11 cc=GB sec=WPA2-Enterprise ciphers=CCMP akms=802.1X phy=n vendors=1",
+  "beacon ssid=\"Free Cafe WiFi\" ch=1 cc= sec=Open ciphers= akms= phy=n vendors=1",
+  "beacon ssid=\"\" hidden ch=6 cc= sec=WPA2 ciphers=CCMP akms=PSK phy=n vendors=0",
+  "beacon ssid=\"\\x00\\x00\\x00\\x00\\x00\\x00\\x00\\x00\" hidden ch=6 cc= sec=WPA2 ciphers=CCMP akms=PSK phy=n vendors=0",
+  "beacon ssid=\"OldRouter\" ch=3 cc= sec=WPA/WPA2 ciphers=CCMP+TKIP akms=PSK phy=bg vendors=1",
+  "probe-resp ssid=\"Modern\" ch=149 cc=DE sec=WPA3 ciphers=CCMP akms=SAE phy=ax vendors=0",
+  "beacon ssid=\"OWE-Guest\" ch=44 cc= sec=OWE ciphers=CCMP akms=OWE phy=ac vendors=0",
+  nullptr,
+};
+
+static uint32_t le32(const uint8_t* p, bool swap) {
+  uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+  return swap ? __builtin_bswap32(v) : v;
+}
+
+// 802.11 frame inside one radiotap record, without the FCS if the flags
+// field announces one; false if the header does not hold together
+static bool stripRadiotap(const uint8_t* p, size_t len, Frame& out) {
+  if(len < 8 || p[0] != 0) return false;
+  size_t headerLen = p[2] | (p[3] << 8);
+  if(headerLen < 8 || headerLen > len) return false;
+
+  // Present words chain through bit 31; fields follow the last one, each
+  // aligned to its own size from the start of the header
+  uint32_t present = le32(p + 4, false);
+  size_t offset = 8;
+  for(uint32_t word = present; word & RADIOTAP_EXT; offset += 4) {
+    if(offset + 4 > headerLen) return false;
+    word = le32(p + offset, false);
+  }
+  bool fcs = false;
+  if(present & RADIOTAP_TSFT) offset = ((offset + 7) & ~(size_t)7) + 8;
+  if(present & RADIOTAP_FLAGS) {
+    if(offset >= headerLen) return false;
+    fcs = p[offset] & RADIOTAP_F_FCS;
+  }
+
+  size_t frameLen = len - headerLen;
+  if(fcs) {
+    if(frameLen < 4) return false;
+    frameLen -= 4;
+  }
+  out.assign(p + headerLen, p + headerLen + frameLen);
+  return true;
+}
+
+// Classic pcap, either byte order, micro- or nanosecond stamps, with raw
+// 802.11 or radiotap link type. Returns the number of frames added, or -1.
+static int loadPcap(const char* path, std::vector<Frame>& out) {
+  FILE* f = fopen(path, "rb");
+  if(!f) {
+    perror(path);
+    return -1;
+  }
+  std::vector<uint8_t> file;
+  uint8_t chunk[4096];
+  for(size_t n; (n = fread(chunk, 1, sizeof(chunk), f)) > 0;) file.insert(file.end(), chunk, chunk + n);
+  fclose(f);
+
+  if(file.size() < 24) {
+    fprintf(stderr, "%s: not a pcap file\n", path);
+    return -1;
+  }
+  uint32_t magic = le32(file.data(), false);
+  bool swap = __builtin_bswap32(magic) == PCAP_MAGIC_US || __builtin_bswap32(magic) == PCAP_MAGIC_NS;
+  if(!swap && magic != PCAP_MAGIC_US && magic != PCAP_MAGIC_NS) {
+    fprintf(stderr, "%s: not a classic pcap file (pcapng is not supported)\n", path);
+    return -1;
+  }
+  uint32_t linkType = le32(file.data() + 20, swap) & 0xffff;
+  if(linkType != LINKTYPE_IEEE802_11 && linkType != LINKTYPE_RADIOTAP) {
+    fprintf(stderr, "%s: link type %u, expected 802.11 (105) or radiotap (127)\n", path, linkType);
+    return -1;
+  }
+
+  int added = 0;
+  for(size_t pos = 24; pos + 16 <= file.size();) {
+    uint32_t captured = le32(file.data() + pos + 8, swap);
+    pos += 16;
+    if(captured > file.size() - pos) {
+      fprintf(stderr, "%s: last record cut short\n", path);
+      break;
+    }
+    Frame frame;
+    if(linkType == LINKTYPE_RADIOTAP) {
+      if(!stripRadiotap(file.data() + pos, captured, frame)) {
+        fprintf(stderr, "%s: skipping a record with a bad radiotap header\n", path);
+        pos += captured;
+        continue;
+      }
+    } else {
+      frame.assign(file.data() + pos, file.data() + pos + captured);
+    }
+    out.push_back(frame);
+    added++;
+    pos += captured;
+  }
+  return added;
+}
+
+static bool inside(const Frame& f, const uint8_t* p, size_t len) {
+  return p >= f.data() && p + len <= f.data() + f.size();
+}
+
+static void fail(const char* what, const Frame& f) {
+  if(violations++ < 10) {
+    printf("violation: %s (frame of %zu bytes:", what, f.size());
+    for(size_t i = 0; i < f.size() && i < 64; i++) printf(" %02x", f[i]);
+    printf("%s)\n", f.size() > 64 ? " ..." : "");
+  }
+}
+
+// Parses `f` from an exactly-sized copy and checks what comes back
+static void check(const Frame& source) {
+  Frame f(source);
+  MgmtFrameInfo info;
+  if(!parseMgmtFrame(f.data(), f.size(), info)) {
+    if(f.size() >= MGMT_HEADER_LEN + BEACON_FIXED_LEN && (f[0] == MGMT_SUBTYPE_BEACON || f[0] == MGMT_SUBTYPE_PROBE_RESP)) {
+      fail("rejected a well-formed header", f);
+    }
+    return;
+  }
+
+  if(!inside(f, info.bssid, 6)) fail("bssid outside the frame", f);
+  if(info.ssid && (info.ssidLen > 32 || !inside(f, info.ssid, info.ssidLen))) fail("ssid outside the frame", f);
+  if(!info.ssid && info.ssidLen) fail("ssid length without ssid", f);
+  if(info.country && !inside(f, info.country, 3)) fail("country outside the frame", f);
+  if(info.vendorCount > MAX_VENDOR_IES) fail("too many vendor IEs", f);
+  for(int i = 0; i < info.vendorCount && i < MAX_VENDOR_IES; i++) {
+    if(!inside(f, info.vendor[i], info.vendorLen[i])) fail("vendor IE outside the frame", f);
+  }
+
+  // The summaries must stay NUL-terminated inside any buffer
+  char buf[FORMAT_BUF];
+  for(size_t size = 1; size <= sizeof(buf); size += 7) {
+    size_t n = formatCiphers(info.security.pairwise, buf, size);
+    if(n >= size || buf[n] != 0) fail("formatCiphers overran its buffer", f);
+    n = formatAkms(info.security.akm, buf, size);
+    if(n >= size || buf[n] != 0) fail("formatAkms overran its buffer", f);
+  }
+  sink += strlen(securityLabel(info.security)) + strlen(phyLabel(info.phy)) + ssidHidden(info);
+}
+
+// One line with everything the analyzer shows of a parsed frame
+static void summary(const MgmtFrameInfo& info, char* out, size_t size) {
+  char ssid[33 * 4 + 1];
+  size_t n = 0;
+  for(int i = 0; i < info.ssidLen; i++) {
+    uint8_t c = info.ssid[i];
+    if(c >= 0x20 && c < 0x7f && c != '"' && c != '\\') ssid[n++] = c;
+    else n += snprintf(ssid + n, sizeof(ssid) - n, "\\x%02x", c);
+  }
+  ssid[n] = 0;
+  char ciphers[64], akms[96];
+  formatCiphers(info.security.pairwise, ciphers, sizeof(ciphers));
+  formatAkms(info.security.akm, akms, sizeof(akms));
+  snprintf(out, size, "%s ssid=\"%s\"%s ch=%u cc=%.2s sec=%s ciphers=%s akms=%s phy=%s vendors=%u",
+           info.subtype == MGMT_SUBTYPE_BEACON ? "beacon" : "probe-resp", ssid, ssidHidden(info) ? " hidden" : "",
+           info.channel, info.country ? (const char*)info.country : "", securityLabel(info.security), ciphers, akms,
+           phyLabel(info.phy), info.vendorCount);
+}
+
+// Returns false, after saying why, unless `frame` parses to `want` (or is
+// rejected, when `want` is null)
+static bool expect(const char* name, const Frame& frame, const char* want) {
+  MgmtFrameInfo info;
+  char got[SUMMARY_MAX];
+  if(!parseMgmtFrame(frame.data(), frame.size(), info)) snprintf(got, sizeof(got), "(rejected)");
+  else summary(info, got, sizeof(got));
+  if(strcmp(got, want ? want : "(rejected)") == 0) return true;
+  printf("mismatch: %s\n  want %s\n  got  %s\n", name, want ? want : "(rejected)", got);
+  return false;
+}
+
+static size_t throughput(double& framesPerSec, double& mbPerSec) {
+  size_t bytes = 0;
+  for(const Frame& f : corpus) bytes += f.size();
+
+  double best = 1e30;
+  for(int round = 0; round < ROUNDS; round++) {
+    auto start = std::chrono::steady_clock::now();
+    for(int r = 0; r < REPEATS; r++) {
+      for(const Frame& f : corpus) {
+        MgmtFrameInfo info;
+        if(parseMgmtFrame(f.data(), f.size(), info)) sink += info.ssidLen + info.security.akm + info.phy;
+      }
+    }
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(s < best) best = s;
+  }
+  uint64_t frames = (uint64_t)corpus.size() * REPEATS;
+  framesPerSec = frames / best;
+  mbPerSec = bytes * (double)REPEATS / best / 1e6;
+  return bytes;
+}
+
+// Offsets of the IE length bytes, walking the well-formed original
+static std::vector<size_t> lengthOffsets(const Frame& f) {
+  std::vector<size_t> offsets;
+  size_t pos = MGMT_HEADER_LEN + BEACON_FIXED_LEN;
+  while(pos + 2 <= f.size() && pos + 2 + f[pos + 1] <= f.size()) {
+    offsets.push_back(pos + 1);
+    pos += 2 + f[pos + 1];
+  }
+  return offsets;
+}
+
+int main(int argc, char** argv) {
+  std::vector<Frame> captured;
+  int mismatches = 0;
+  if(argc > 1) {
+    for(int i = 1; i < argc; i++) {
+      if(loadPcap(argv[i], captured) < 0) return 1;
+    }
+  } else {
+    int n = loadPcap(DEFAULT_PCAP, captured);
+    if(n < 0) return 1;
+    if(n != (int)(sizeof(sampleSummaries) / sizeof(sampleSummaries[0]))) {
+      printf("mismatch: %s holds %d frames, expected %zu\n", DEFAULT_PCAP, n,
+             sizeof(sampleSummaries) / sizeof(sampleSummaries[0]));
+      mismatches++;
+    }
+    for(int i = 0; i < n && i < (int)(sizeof(sampleSummaries) / sizeof(sampleSummaries[0])); i++) {
+      char name[64];
+      snprintf(name, sizeof(name), "%s frame %d", DEFAULT_PCAP, i + 1);
+      mismatches += !expect(name, captured[i], sampleSummaries[i]);
+    }
+  }
+  corpus.insert(corpus.end(), captured.begin(), captured.end());
+
+  RfSimConfig config;
+  config.apCount = 400;
+  config.areaMeters = 60;
+  config.hiddenFraction = 0.1f;
+  RfSim sim(config);
+  for(uint8_t channel = 1; channel <= RF_SIM_CHANNELS; channel++) sim.beacons(channel, collect);
+  addHandBuilt();
+  for(const Expected& e : expected) mismatches += !expect(e.name, e.frame, e.summary);
+
+  double framesPerSec, mbPerSec;
+  size_t bytes = throughput(framesPerSec, mbPerSec);
+  printf("corpus: %zu frames (%zu captured), %zu bytes\n", corpus.size(), captured.size(), bytes);
+  printf("expected fields: %d mismatches\n", mismatches);
+  printf("parse: %.0f frames/s, %.0f MB/s\n", framesPerSec, mbPerSec);
+
+  uint64_t cases = 0;
+  for(const Frame& original : corpus) {
+    for(size_t len = 0; len <= original.size(); len++) {
+      check(Frame(original.begin(), original.begin() + len));
+      cases++;
+    }
+    for(size_t offset : lengthOffsets(original)) {
+      uint8_t len = original[offset];
+      const uint8_t forced[] = { 0, (uint8_t)(len - 1), (uint8_t)(len + 1), 0xff };
+      for(uint8_t value : forced) {
+        Frame f(original);
+        f[offset] = value;
+        check(f);
+        cases++;
+      }
+    }
+  }
+
+  std::mt19937 rng(1);
+  for(int i = 0; i < MUTATION_CASES; i++) {
+    Frame f(corpus[rng() % corpus.size()]);
+    int mutations = 1 + rng() % MUTATIONS_MAX;
+    for(int m = 0; m < mutations; m++) {
+      switch(rng() % 4) {
+        case 0:
+          // Any byte of the IE list, header left intact so the frame parses
+          if(f.size() > MGMT_HEADER_LEN + BEACON_FIXED_LEN) {
+            f[MGMT_HEADER_LEN + BEACON_FIXED_LEN + rng() % (f.size() - MGMT_HEADER_LEN - BEACON_FIXED_LEN)] = rng();
+          }
+          break;
+        case 1:
+          f.resize(rng() % (f.size() + 1));
+          break;
+        case 2:
+          for(int n = rng() % 16; n > 0; n--) f.push_back(rng());
+          break;
+        case 3:
+          if(!f.empty()) f[rng() % f.size()] ^= 1 << (rng() % 8);
+          break;
+      }
+    }
+    check(f);
+    cases++;
+  }
+
+  printf("fuzz: %llu malformed frames, %u violations\n", (unsigned long long)cases, violations);
+  return violations || mismatches ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+// Host benchmark for the SSID escaper against memcpy and a byte-at-a-time
+// escaper. Build from the repo root:
+//   g++ -O2 -std=gnu++17 -Isrc bench/bench_json_escape.cpp src/json_escape.cpp -o bench_json_escape
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "json_escape.h"
+
+#define SSID_COUNT 4096
+#define ROUNDS 20
+#define REPEATS 200
+#define DENSE -1
+
+static volatile size_t sink;
+
+static size_t naiveEscape(const char* in, size_t len, char* out) {
+  size_t n = 0;
+  for(size_t i = 0; i < len; i++) {
+    char c = in[i];
+    if(c == '"' || c == '\\') {
+      out[n++] = '\\';
+      out[n++] = c;
+    } else if((unsigned char)c < 0x20) {
+      n += snprintf(out + n, 7, "\\u%04x", c);
+    } else {
+      out[n++] = c;
+    }
+  }
+  return n;
+}
+
+struct Corpus {
+  std::vector<char> bytes;
+  std::vector<size_t> offsets;
+  std::vector<uint8_t> lengths;
+};
+
+// `dirtyPercent` of SSIDs get one byte that needs escaping or is non-ASCII.
+// DENSE makes every byte take the per-byte path: SSIDs of 3-byte UTF-8
+// characters with quotes and control bytes between them.
+static Corpus makeCorpus(int dirtyPercent) {
+  static const char dirty[] = { '"', '\\', '\n', (char)0xC3, (char)0xFF };
+  static const char* const dense[] = { "\xe6\x97\xa5", "\xe6\x9c\xac", "\"", "\\", "\t", "\x01" };
+  Corpus c;
+  srand(42);
+  for(int i = 0; i < SSID_COUNT; i++) {
+    uint8_t len = 8 + rand() % 25;
+    c.offsets.push_back(c.bytes.size());
+    if(dirtyPercent == DENSE) {
+      size_t start = c.bytes.size();
+      while(c.bytes.size() - start + 3 <= len) {
+        const char* piece = dense[rand() % (sizeof(dense) / sizeof(dense[0]))];
+        c.bytes.insert(c.bytes.end(), piece, piece + strlen(piece));
+      }
+      c.lengths.push_back(c.bytes.size() - start);
+      continue;
+    }
+    c.lengths.push_back(len);
+    for(int j = 0; j < len; j++) c.bytes.push_back('a' + rand() % 26);
+    if(rand() % 100 < dirtyPercent) c.bytes[c.offsets.back() + rand() % len] = dirty[rand() % sizeof(dirty)];
+  }
+  return c;
+}
+
+typedef size_t (*EscapeFn)(const char* in, size_t len, char* out);
+
+static size_t copyOnly(const char* in, size_t len, char* out) {
+  memcpy(out, in, len);
+  return len;
+}
+
+// Called through a volatile pointer so none of the candidates get inlined
+// into the loop and optimized differently. Best of REPEATS short bursts,
+// to keep other load on the host out of the comparison.
+static double run(const Corpus& c, EscapeFn target) {
+  volatile EscapeFn fn = target;
+  char out[32 * JSON_ESCAPE_MAX];
+  double best = 0;
+  for(int rep = 0; rep < REPEATS; rep++) {
+    auto start = std::chrono::steady_clock::now();
+    size_t total = 0;
+    for(int r = 0; r < ROUNDS; r++) {
+      for(int i = 0; i < SSID_COUNT; i++) total += fn(&c.bytes[c.offsets[i]], c.lengths[i], out);
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    sink = total;
+    double rate = (double)c.bytes.size() * ROUNDS / secs / 1e6;
+    if(rate > best) best = rate;
+  }
+  return best;
+}
+
+int main() {
+  const int mixes[] = { 0, 10, 100, DENSE };
+  printf("%-10s %12s %12s %12s\n", "dirty %", "memcpy MB/s", "escape MB/s", "naive MB/s");
+  for(int dirtyPercent : mixes) {
+    Corpus c = makeCorpus(dirtyPercent);
+    double copy = run(c, copyOnly);
+    double escape = run(c, jsonEscape);
+    double naive = run(c, naiveEscape);
+    char label[8];
+    if(dirtyPercent == DENSE) snprintf(label, sizeof(label), "dense");
+    else snprintf(label, sizeof(label), "%d", dirtyPercent);
+    printf("%-10s %12.0f %12.0f %12.0f\n", label, copy, escape, naive);
+  }
+  return 0;
+}
@@ -0,0 +1,404 @@
+// End-to-end HTTP load harness. Keep-alive clients poll the dashboard's
+// endpoints (/, /scan, /scan?since=, a sorted page of /scan) while /events
+// and /live subscribers hold streams open and, optionally, stalled clients
+// request /scan and never read it. Reports per-endpoint p50/p99/p999
+// latency, requests/s, how evenly the clients were served and what the
+// streams received. Latency runs from connect() for a client's first
+// request on a connection, so time spent waiting to be accepted counts. A
+// request still unanswered STOP_GRACE_MS after the run ends is a failure,
+// and so is a client that never got a response: the run then exits
+// non-zero.
+//
+// By default it runs the analyzer in-process on the native HAL, with the
+// scanner sweeping a simulated environment in the background, and talks to
+// it over loopback. --target sends the same load to a running instance
+// instead: the native program or a device over its local link.
+//
+// Build from the repo root (after python3 tools/embed_web.py):
+//   g++ -O2 -std=gnu++17 -pthread -Isrc bench/load_http.cpp $(ls src/*.cpp | grep -v main.cpp) src/native/hal.cpp src/native/psram.cpp src/native/rf_sim.cpp -o load_http
+// Run: ./load_http [--clients N] [--events N] [--live N] [--stalled N]
+//                  [--seconds S] [--aps N] [--target HOST:PORT]
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "analyzer.h"
+#include "http_server.h"
+#include "native/rf_sim.h"
+
+#define LOCAL_PORT 18081
+#define WARMUP_MS 3000
+#define STREAM_TIMEOUT_MS 500
+#define STOP_GRACE_MS 2000
+#define RESPONSE_BUFFER 65536
+
+typedef std::chrono::steady_clock Clock;
+
+enum Endpoint { PAGE, SCAN_FULL, SCAN_DELTA, SCAN_VIEW, ENDPOINTS };
+static const char* const endpointNames[ENDPOINTS] = { "/", "/scan", "/scan?since=", "/scan?sort=rssi&limit=50" };
+// Out of every eight requests, like a dashboard that mostly polls deltas
+static const Endpoint mix[8] = { PAGE, SCAN_FULL, SCAN_DELTA, SCAN_DELTA, SCAN_DELTA, SCAN_VIEW, SCAN_DELTA, SCAN_VIEW };
+
+static struct sockaddr_in target;
+static std::atomic<bool> running(true);
+static Clock::time_point graceEnd;
+
+// A request sent before the end of the run is waited for a little longer
+static bool awaiting() {
+  return running || Clock::now() < graceEnd;
+}
+
+struct ClientStats {
+  std::vector<double> latency[ENDPOINTS];
+  uint64_t bytes = 0;
+  uint64_t completed = 0;
+  int failures = 0;
+};
+
+struct StreamStats {
+  std::atomic<uint64_t> messages{0};
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<int> failures{0};
+};
+
+static StreamStats eventStats, liveStats;
+
+static int connectTarget() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if(connect(fd, (struct sockaddr*)&target, sizeof(target)) < 0) {
+    close(fd);
+    return -1;
+  }
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  // Streams wake up now and then to notice the run is over
+  struct timeval tv = { 0, STREAM_TIMEOUT_MS * 1000 };
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  return fd;
+}
+
+static bool sendAll(int fd, const char* data, size_t len) {
+  while(len > 0) {
+    ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+    if(n <= 0) return false;
+    data += n;
+    len -= n;
+  }
+  return true;
+}
+
+// Reads one Content-Length response into `buf`; returns the status or -1.
+// The body starts at `bodyAt`; `closing` is set if the server announced it
+// will close the connection.
+static int readResponse(int fd, std::vector<char>& buf, size_t& bodyAt, size_t& total, bool& closing) {
+  size_t have = 0, headLen = 0, bodyLen = 0;
+  int status = -1;
+  for(;;) {
+    if(buf.size() - have < 4096) buf.resize(buf.size() * 2);
+    ssize_t n = recv(fd, buf.data() + have, buf.size() - have - 1, 0);
+    if(n <= 0) {
+      if(n < 0 && errno == EAGAIN && awaiting()) continue;
+      return -1;
+    }
+    have += n;
+    buf[have] = 0;
+    if(headLen == 0) {
+      char* end = strstr(buf.data(), "\r\n\r\n");
+      if(!end) continue;
+      headLen = end + 4 - buf.data();
+      status = atoi(buf.data() + 9);
+      const char* cl = strcasestr(buf.data(), "Content-Length: ");
+      if(!cl || cl > end) return -1;
+      bodyLen = strtoul(cl + 16, nullptr, 10);
+      const char* conn = strcasestr(buf.data(), "Connection: close");
+      closing = conn && conn < end;
+    }
+    if(have >= headLen + bodyLen) {
+      bodyAt = headLen;
+      total = headLen + bodyLen;
+      return have == total ? status : -1;
+    }
+  }
+}
+
+static void client(int id, ClientStats* stats) {
+  std::vector<char> buf(RESPONSE_BUFFER);
+  char boot[9] = "";
+  unsigned long gen = 0;
+  int fd = -1;
+  for(int i = id; running; i++) {
+    Clock::time_point t0 = Clock::now();
+    if(fd < 0 && (fd = connectTarget()) < 0) {
+      stats->failures++;
+      usleep(100000);
+      continue;
+    }
+
+    Endpoint endpoint = mix[i % 8];
+    char request[160];
+    const char* path = endpointNames[endpoint];
+    char since[48];
+    if(endpoint == SCAN_DELTA) {
+      snprintf(since, sizeof(since), "/scan?since=%s-%lu", boot, gen);
+      path = since;
+    }
+    snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: load\r\n\r\n", path);
+
+    size_t bodyAt, total;
+    bool closing = false;
+    int status = sendAll(fd, request, strlen(request)) ? readResponse(fd, buf, bodyAt, total, closing) : -1;
+    if(status != 200 && status != 304) {
+      stats->failures++;
+      close(fd);
+      fd = -1;
+      continue;
+    }
+    stats->latency[endpoint].push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+    stats->bytes += total;
+    stats->completed++;
+    if(closing) {
+      close(fd);
+      fd = -1;
+    }
+
+    const char* b = status == 200 && endpoint != PAGE ? strstr(buf.data() + bodyAt, "\"boot\":\"") : nullptr;
+    const char* g = b ? strstr(b, "\"gen\":") : nullptr;
+    if(g) {
+      memcpy(boot, b + 8, 8);
+      gen = strtoul(g + 6, nullptr, 10);
+    }
+  }
+  if(fd >= 0) close(fd);
+}
+
+static void eventSubscriber() {
+  int fd = connectTarget();
+  const char* req = "GET /events HTTP/1.1\r\nHost: load\r\nAccept: text/event-stream\r\n\r\n";
+  if(fd < 0 || !sendAll(fd, req, strlen(req))) {
+    eventStats.failures++;
+    if(fd >= 0) close(fd);
+    return;
+  }
+  char buf[16384];
+  // Carries a partial "event: scan" marker over from the previous read
+  size_t keep = 0;
+  while(running) {
+    ssize_t n = recv(fd, buf + keep, sizeof(buf) - keep - 1, 0);
+    if(n < 0 && errno == EAGAIN) continue;
+    if(n <= 0) {
+      if(running) eventStats.failures++;
+      break;
+    }
+    eventStats.bytes += n;
+    size_t len = keep + n;
+    buf[len] = 0;
+    for(const char* p = buf; (p = strstr(p, "event: scan")); p++) eventStats.messages++;
+    keep = std::min(len, (size_t)10);
+    memmove(buf, buf + len - keep, keep);
+  }
+  close(fd);
+}
+
+static void liveSubscriber() {
+  int fd = connectTarget();
+  const char* req = "GET /live HTTP/1.1\r\nHost: load\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                    "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+  if(fd < 0 || !sendAll(fd, req, strlen(req))) {
+    liveStats.failures++;
+    if(fd >= 0) close(fd);
+    return;
+  }
+  std::vector<uint8_t> buf(65536);
+  size_t have = 0;
+  bool upgraded = false;
+  while(running) {
+    ssize_t n = recv(fd, buf.data() + have, buf.size() - have, 0);
+    if(n < 0 && errno == EAGAIN) continue;
+    if(n <= 0) {
+      if(running) liveStats.failures++;
+      break;
+    }
+    have += n;
+    liveStats.bytes += n;
+
+    size_t pos = 0;
+    if(!upgraded) {
+      uint8_t* end = (uint8_t*)memmem(buf.data(), have, "\r\n\r\n", 4);
+      if(!end) continue;
+      if(memcmp(buf.data(), "HTTP/1.1 101", 12) != 0) {
+        liveStats.failures++;
+        break;
+      }
+      upgraded = true;
+      pos = end + 4 - buf.data();
+    }
+    // Server frames are unmasked: opcode, 7-bit length or 126 + u16
+    for(;;) {
+      if(have - pos < 2) break;
+      size_t len = buf[pos + 1] & 0x7f, header = 2;
+      if(len == 126) {
+        if(have - pos < 4) break;
+        len = (buf[pos + 2] << 8) | buf[pos + 3];
+        header = 4;
+      }
+      if(have - pos < header + len) break;
+      liveStats.messages++;
+      pos += header + len;
+    }
+    memmove(buf.data(), buf.data() + pos, have - pos);
+    have -= pos;
+  }
+  close(fd);
+}
+
+// Asks for the full list and never reads it
+static int stalledClient() {
+  int fd = connectTarget();
+  if(fd < 0) return -1;
+  int small = 4096;
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+  const char* req = "GET /scan HTTP/1.1\r\nHost: load\r\n\r\n";
+  sendAll(fd, req, strlen(req));
+  return fd;
+}
+
+static double percentile(std::vector<double>& v, double p) {
+  size_t i = std::min(v.size() - 1, (size_t)(p * v.size()));
+  std::nth_element(v.begin(), v.begin() + i, v.end());
+  return v[i];
+}
+
+static bool parseTarget(const char* spec) {
+  char host[64];
+  const char* colon = strrchr(spec, ':');
+  size_t len = colon ? colon - spec : strlen(spec);
+  if(len >= sizeof(host)) return false;
+  memcpy(host, spec, len);
+  host[len] = 0;
+  target.sin_family = AF_INET;
+  target.sin_port = htons(colon ? atoi(colon + 1) : 80);
+  return inet_pton(AF_INET, host, &target.sin_addr) == 1;
+}
+
+int main(int argc, char** argv) {
+  int clients = 4, events = 2, live = 2, stalled = 0, seconds = 10;
+  RfSimConfig sim;
+  sim.apCount = 500;
+  sim.churnPerMinute = 0.1f;
+  const char* remote = nullptr;
+
+  for(int i = 1; i + 1 < argc; i += 2) {
+    const char* arg = argv[i];
+    const char* value = argv[i + 1];
+    if(strcmp(arg, "--clients") == 0) clients = atoi(value);
+    else if(strcmp(arg, "--events") == 0) events = atoi(value);
+    else if(strcmp(arg, "--live") == 0) live = atoi(value);
+    else if(strcmp(arg, "--stalled") == 0) stalled = atoi(value);
+    else if(strcmp(arg, "--seconds") == 0) seconds = atoi(value);
+    else if(strcmp(arg, "--aps") == 0) sim.apCount = atoi(value);
+    else if(strcmp(arg, "--target") == 0) remote = value;
+    else {
+      fprintf(stderr, "unknown option %s\n", arg);
+      return 1;
+    }
+  }
+  if(clients + events + live + stalled > HTTP_MAX_CONNECTIONS) {
+    fprintf(stderr, "note: %d connections, the server serves %d at once; the rest wait to be accepted\n",
+            clients + events + live + stalled, HTTP_MAX_CONNECTIONS);
+  }
+
+  if(remote) {
+    if(!parseTarget(remote)) {
+      fprintf(stderr, "bad target %s, expected IPv4:port\n", remote);
+      return 1;
+    }
+  } else {
+    rfSimInstall(new RfSim(sim), false);
+    if(!analyzerBegin(LOCAL_PORT)) {
+      fprintf(stderr, "cannot listen on %d\n", LOCAL_PORT);
+      return 1;
+    }
+    std::thread([] {
+      for(;;) analyzerLoop();
+    }).detach();
+    char local[32];
+    snprintf(local, sizeof(local), "127.0.0.1:%d", LOCAL_PORT);
+    parseTarget(local);
+    // Let the first sweeps fill the table
+    usleep(WARMUP_MS * 1000);
+  }
+
+  std::vector<int> stalledFds;
+  for(int i = 0; i < stalled; i++) stalledFds.push_back(stalledClient());
+
+  std::vector<std::thread> threads;
+  for(int i = 0; i < events; i++) threads.emplace_back(eventSubscriber);
+  for(int i = 0; i < live; i++) threads.emplace_back(liveSubscriber);
+  std::vector<ClientStats> stats(clients);
+  Clock::time_point t0 = Clock::now();
+  for(int i = 0; i < clients; i++) threads.emplace_back(client, i, &stats[i]);
+
+  usleep(seconds * 1000000);
+  Clock::time_point stopAt = Clock::now();
+  graceEnd = stopAt + std::chrono::milliseconds(STOP_GRACE_MS);
+  running = false;
+  for(std::thread& t : threads) t.join();
+  double elapsed = std::chrono::duration<double>(stopAt - t0).count();
+  for(int fd : stalledFds) {
+    if(fd >= 0) close(fd);
+  }
+
+  printf("%d clients, %d /events, %d /live, %d stalled, %.1f s%s\n", clients, events, live, stalled, elapsed,
+         remote ? "" : ", in-process with a background sweep");
+  printf("%-26s %8s %10s %10s %10s\n", "endpoint", "requests", "p50 us", "p99 us", "p999 us");
+  size_t requests = 0;
+  uint64_t bytes = 0;
+  int failures = 0;
+  std::vector<double> all;
+  for(int e = 0; e < ENDPOINTS; e++) {
+    std::vector<double> merged;
+    for(ClientStats& s : stats) merged.insert(merged.end(), s.latency[e].begin(), s.latency[e].end());
+    all.insert(all.end(), merged.begin(), merged.end());
+    if(merged.empty()) continue;
+    printf("%-26s %8zu %10.0f %10.0f %10.0f\n", endpointNames[e], merged.size(), percentile(merged, 0.50),
+           percentile(merged, 0.99), percentile(merged, 0.999));
+  }
+  for(ClientStats& s : stats) {
+    bytes += s.bytes;
+    failures += s.failures;
+  }
+  requests = all.size();
+  if(!all.empty()) {
+    printf("%-26s %8zu %10.0f %10.0f %10.0f\n", "all", requests, percentile(all, 0.50), percentile(all, 0.99),
+           percentile(all, 0.999));
+  }
+  printf("%.0f requests/s, %.1f MB/s, %d failed\n", requests / elapsed, bytes / elapsed / 1e6, failures);
+
+  // Fairness: a server that lets a few connections hold every slot shows
+  // up here, not in the latency of the requests that did get through
+  std::vector<uint64_t> completed;
+  for(ClientStats& s : stats) completed.push_back(s.completed);
+  std::sort(completed.begin(), completed.end());
+  int starved = std::count(completed.begin(), completed.end(), 0);
+  if(!completed.empty()) {
+    printf("per client: min %llu (%.1f/s), median %llu, max %llu responses, %d with none\n",
+           (unsigned long long)completed.front(), completed.front() / elapsed,
+           (unsigned long long)completed[completed.size() / 2], (unsigned long long)completed.back(), starved);
+  }
+  printf("/events: %llu scan events, %llu bytes, %d failed\n", (unsigned long long)eventStats.messages.load(),
+         (unsigned long long)eventStats.bytes.load(), eventStats.failures.load());
+  printf("/live: %llu frames (%.1f/s), %llu bytes, %d failed\n", (unsigned long long)liveStats.messages.load(),
+         liveStats.messages.load() / elapsed, (unsigned long long)liveStats.bytes.load(), liveStats.failures.load());
+  return failures + starved + eventStats.failures + liveStats.failures ? 1 : 0;
+}
@@ -0,0 +1,1213 @@
+#include "analyzer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
+#include <atomic>
+#include "hal.h"
+#include "dwell_planner.h"
+#include "capture.h"
+#include "ie_parser.h"
+#include "network_info.h"
+#include "bss_table.h"
+#include "json_writer.h"
+#include "psram.h"
+#include "shared_body.h"
+#include "http_server.h"
+#include "websocket.h"
+#include "live_feed.h"
+#include "metrics.h"
+#include "web_index.h"
+
+HttpServer server;
+
+#define BSS_TABLE_INITIAL 64
+#define BSS_TABLE_MAX 4096
+#define BSS_TTL_MS 60000
+#define DELTA_RSSI_THRESHOLD 3
+#define TOMBSTONE_COUNT 256
+#define JSON_CHUNK_SIZE 512
+#define RENDER_MAX_NETWORKS 256
+#define RENDER_CACHE_SLOTS 4
+#define SSE_MAX_CLIENTS 3
+#define SSE_MIN_INTERVAL_MS 500
+#define SSE_KEEPALIVE_MS 15000
+#define SSE_BACKLOG_MAX 16384
+#define LIVE_MAX_CLIENTS 3
+#define LIVE_INTERVAL_MS 50
+#define SORT_INSERTION_BUDGET 8
+#define HTTP_POLL_MS 10
+#define HTTP_PLAIN_SLOTS 4
+#define STREAM_EVENTS 1
+#define STREAM_LIVE 2
+
+#define CHANNEL_COUNT 13
+#define CHANNELS_PER_TICK 1
+#define SCAN_TICK_GAP_MS 30
+// A channel with APs gets at least one 100 TU beacon interval, with margin;
+// bench/bench_dwell.cpp checks what shorter dwells would miss
+#define SWEEP_BUDGET_MS 1600
+#define MIN_DWELL_MS 20
+#define MAX_DWELL_MS 250
+#define BUSY_DWELL_MS 110
+#define SCANNER_CORE 0
+#define SCANNER_STACK 4096
+#define SCANNER_PRIORITY 1
+
+// Streams hold their connection for good; the rest is kept for plain
+// requests so /scan and the page still load with every stream taken
+static_assert(SSE_MAX_CLIENTS + LIVE_MAX_CLIENTS + HTTP_PLAIN_SLOTS <= HTTP_MAX_CONNECTIONS,
+              "streams must leave slots for plain HTTP");
+
+// Double-buffered scan results: the scanner task copies its BSS table into the
+// back buffer and publishes it by swapping the front pointer. Readers pin the
+// front buffer while they read it; if the back buffer is still pinned the
+// scanner skips publishing for that tick instead of waiting.
+// Hot fields are also kept as separate arrays so sorting and filtering only
+// touch the bytes they compare.
+struct ScanSnapshot {
+  NetworkInfo* networks;
+  int8_t* rssi;
+  uint8_t* channel;
+  uint32_t* lastSeen;
+  uint32_t capacity;
+  uint32_t count;
+  // Table state this buffer was copied from, for incremental refreshes
+  uint32_t tableStamp;
+  uint32_t tableLayout;
+  uint32_t generation;
+  unsigned long time;
+  std::atomic<int> readers;
+  
+  // Sorted index permutations, built on demand by the HTTP task and owned
+  // by it; the scanner never touches them
+  uint16_t* order[SORT_KEYS];
+  uint32_t orderCapacity[SORT_KEYS];
+  uint32_t orderCount[SORT_KEYS];
+  uint32_t orderLayout[SORT_KEYS];
+  uint32_t orderGeneration[SORT_KEYS];
+};
+
+static_assert(BSS_TABLE_MAX <= 65536, "sort permutations hold 16-bit indexes");
+
+ScanSnapshot snapshots[2];
+std::atomic<ScanSnapshot*> frontSnapshot(&snapshots[0]);
+std::atomic<uint32_t> scanGeneration(0);
+volatile unsigned long lastScan = 0;
+volatile bool scanRunning = false;
+
+// Merged BSS table, written by the scanner and capture tasks under tableMutex
+HalMutex tableMutex;
+BssTable bssTable;
+bool bssDirty = false;
+
+// Feed ids are 16 bits on the wire and the counter wraps after a long
+// uptime, so ids still held by a record are skipped; 0 is never used
+#define FEED_ID_WORDS (65536 / 32)
+uint32_t feedIdsInUse[FEED_ID_WORDS];
+static_assert(BSS_TABLE_MAX < 65535, "every record needs its own feed id");
+uint16_t nextFeedId = 1;
+
+// Ring of recently removed BSSIDs for /scan?since=. Before a slot is reused
+// its generation is raised into tombstoneFloor, so readers can tell when a
+// removal they needed has been overwritten and fall back to a full list.
+struct Tombstone {
+  uint8_t bssid[6];
+  uint32_t generation;
+};
+
+Tombstone tombstones[TOMBSTONE_COUNT];
+std::atomic<uint32_t> tombstoneHead(0);
+std::atomic<uint32_t> tombstoneFloor(0);
+DwellPlanner dwellPlanner(SWEEP_BUDGET_MS, MIN_DWELL_MS, MAX_DWELL_MS, BUSY_DWELL_MS);
+
+// Always-on metrics for /metrics. Histograms and the scanner's counters
+// are updated with relaxed atomics; the rest are written by one task only.
+LogHistogram sweepMs;
+LogHistogram dwellMs[CHANNEL_COUNT];
+std::atomic<uint32_t> channelScans(0);
+std::atomic<uint32_t> scanFailures(0);
+std::atomic<uint32_t> sweeps(0);
+uint32_t bssExpired = 0;     // under tableMutex
+uint32_t eventsDropped = 0;  // HTTP task
+
+const char* getEncryptionType(uint8_t type) {
+  switch(type) {
+    case AUTH_OPEN: return "Open";
+    case AUTH_WEP: return "WEP";
+    case AUTH_WPA_PSK: return "WPA";
+    case AUTH_WPA2_PSK: return "WPA2";
+    case AUTH_WPA_WPA2_PSK: return "WPA/WPA2";
+    case AUTH_WPA2_ENTERPRISE: return "WPA2-Enterprise";
+    case AUTH_WPA3_PSK: return "WPA3";
+    default: return "Unknown";
+  }
+}
+
+ScanSnapshot* acquireSnapshot() {
+  for(;;) {
+    ScanSnapshot* snap = frontSnapshot.load();
+    snap->readers++;
+    if(snap == frontSnapshot.load()) return snap;
+    snap->readers--;
+  }
+}
+
+void releaseSnapshot(ScanSnapshot* snap) {
+  snap->readers--;
+}
+
+void publishSnapshot(ScanSnapshot* back) {
+  back->generation = ++scanGeneration;
+  back->time = halMillis();
+  frontSnapshot.store(back);
+  lastScan = back->time;
+}
+
+bool reserveSnapshot(ScanSnapshot* snap, uint32_t count) {
+  if(snap->capacity >= count) return true;
+  
+  uint32_t capacity = snap->capacity ? snap->capacity : BSS_TABLE_INITIAL;
+  while(capacity < count) capacity *= 2;
+  
+  NetworkInfo* networks = (NetworkInfo*)psramAlloc(sizeof(NetworkInfo) * capacity);
+  int8_t* rssi = (int8_t*)psramAlloc(capacity);
+  uint8_t* channel = (uint8_t*)psramAlloc(capacity);
+  uint32_t* lastSeen = (uint32_t*)psramAlloc(sizeof(uint32_t) * capacity);
+  if(!networks || !rssi || !channel || !lastSeen) {
+    psramFree(networks);
+    psramFree(rssi);
+    psramFree(channel);
+    psramFree(lastSeen);
+    return false;
+  }
+  
+  psramFree(snap->networks);
+  psramFree(snap->rssi);
+  psramFree(snap->channel);
+  psramFree(snap->lastSeen);
+  snap->networks = networks;
+  snap->rssi = rssi;
+  snap->channel = channel;
+  snap->lastSeen = lastSeen;
+  snap->capacity = capacity;
+  return true;
+}
+
+void tryPublishSnapshot() {
+  ScanSnapshot* back = frontSnapshot.load() == &snapshots[0] ? &snapshots[1] : &snapshots[0];
+  if(back->readers.load() > 0) return;
+  
+  uint32_t count = bssTable.size();
+  uint32_t capacity = back->capacity;
+  if(!reserveSnapshot(back, count)) return;
+  
+  // If nothing was removed since this buffer was last filled, records still
+  // sit at the same indexes and only the ones upserted since need copying
+  bool incremental = back->capacity == capacity && back->generation != 0 && back->tableLayout == bssTable.layout();
+  
+  for(uint32_t i = 0; i < count; i++) {
+    if(incremental && bssTable.stampAt(i) <= back->tableStamp) continue;
+    const NetworkInfo& net = bssTable.at(i);
+    back->networks[i] = net;
+    back->rssi[i] = net.rssi;
+    back->channel[i] = net.channel;
+    back->lastSeen[i] = net.lastSeen;
+  }
+  back->count = count;
+  back->tableStamp = bssTable.stamp();
+  back->tableLayout = bssTable.layout();
+  publishSnapshot(back);
+  bssDirty = false;
+}
+
+// Writers run under tableMutex, so the next published generation is known
+uint32_t nextGeneration() {
+  return scanGeneration.load() + 1;
+}
+
+// At most BSS_TABLE_MAX of the 65535 ids are held, so the search is short
+uint16_t allocateFeedId() {
+  while(nextFeedId == 0 || (feedIdsInUse[nextFeedId / 32] >> (nextFeedId % 32)) & 1) nextFeedId++;
+  uint16_t id = nextFeedId++;
+  feedIdsInUse[id / 32] |= 1u << (id % 32);
+  return id;
+}
+
+// Every removal, expired or evicted, comes through here
+void recordRemoval(const NetworkInfo& net) {
+  feedIdsInUse[net.feedId / 32] &= ~(1u << (net.feedId % 32));
+  
+  uint32_t head = tombstoneHead.load();
+  Tombstone& slot = tombstones[head % TOMBSTONE_COUNT];
+  if(head >= TOMBSTONE_COUNT) tombstoneFloor.store(slot.generation);
+  
+  memcpy(slot.bssid, net.bssid, sizeof(slot.bssid));
+  slot.generation = nextGeneration();
+  tombstoneHead.store(head + 1);
+}
+
+NetworkInfo* upsertBss(const uint8_t* mac, bool* inserted) {
+  NetworkInfo* net = bssTable.upsert(mac, inserted);
+  if(!net) return nullptr;
+  
+  uint32_t now = halMillis();
+  if(*inserted) {
+    memcpy(net->bssid, mac, sizeof(net->bssid));
+    net->firstSeen = now;
+    net->feedId = allocateFeedId();
+  }
+  net->lastSeen = now;
+  net->seenCount++;
+  return net;
+}
+
+// Stamps the record with the next generation if a client holding an older
+// copy would see a difference; small RSSI jitter does not count
+void noteChange(NetworkInfo& net, const NetworkInfo& before, bool inserted) {
+  bool changed = inserted ||
+    net.channel != before.channel ||
+    net.encryption != before.encryption ||
+    net.flags != before.flags ||
+    net.phy != before.phy ||
+    net.ssidLen != before.ssidLen ||
+    memcmp(net.ssid, before.ssid, net.ssidLen) != 0 ||
+    net.security.flags != before.security.flags ||
+    net.security.pairwise != before.security.pairwise ||
+    net.security.akm != before.security.akm ||
+    abs(net.rssi - net.reportedRssi) >= DELTA_RSSI_THRESHOLD;
+  
+  if(changed) {
+    net.changedGen = nextGeneration();
+    net.reportedRssi = net.rssi;
+  }
+}
+
+void mergeScanResult(const ScanResult& ap) {
+  bool inserted;
+  NetworkInfo* net = upsertBss(ap.bssid, &inserted);
+  if(!net) return;
+  NetworkInfo before = *net;
+  
+  setSsid(*net, ap.ssid, ap.ssidLen);
+  net->rssi = ap.rssi;
+  net->channel = ap.channel;
+  net->encryption = ap.authmode;
+  net->flags = net->ssidLen == 0 ? net->flags | NET_HIDDEN : net->flags & ~NET_HIDDEN;
+  noteChange(*net, before, inserted);
+  livePush(net->feedId, net->rssi, net->channel);
+}
+
+void mergeChannelResults(int count) {
+  for(int i = 0; i < count; i++) {
+    ScanResult ap;
+    if(halScanResult(i, ap)) mergeScanResult(ap);
+  }
+  
+  if(count > 0) bssDirty = true;
+}
+
+// The LRU tail is always the BSS seen longest ago, so expiry only ever
+// looks at records that are actually stale
+void expireStaleBss() {
+  uint32_t now = halMillis();
+  for(;;) {
+    int32_t oldest = bssTable.oldest();
+    if(oldest < 0 || now - bssTable.at(oldest).lastSeen < BSS_TTL_MS) break;
+    recordRemoval(bssTable.at(oldest));
+    bssTable.removeAt(oldest);
+    bssExpired++;
+    bssDirty = true;
+  }
+}
+
+// A capture slot keeps only the first CAPTURE_FRAME_MAX bytes, so beacons
+// with long IE lists arrive cut off. The parser only reports IEs it saw
+// whole; what lies past the cut is unknown, not absent, so a cut frame adds
+// what it shows to the record and clears nothing.
+void mergeTruncated(NetworkInfo& net, const MgmtFrameInfo& info) {
+  net.security.flags |= info.security.flags;
+  net.security.pairwise |= info.security.pairwise;
+  net.security.akm |= info.security.akm;
+  if(info.security.groupCipher) net.security.groupCipher = info.security.groupCipher;
+  if(info.security.flags & SEC_RSN) net.security.rsnCapabilities = info.security.rsnCapabilities;
+  net.phy |= info.phy;
+  if(info.country) {
+    net.country[0] = info.country[0];
+    net.country[1] = info.country[1];
+  }
+}
+
+// Called from the capture task for every parsed beacon or probe response
+void onBeacon(const MgmtFrameInfo& info, const CapturedFrame& frame) {
+  halMutexLock(tableMutex);
+  bool inserted;
+  NetworkInfo* net = upsertBss(info.bssid, &inserted);
+  if(net) {
+    NetworkInfo before = *net;
+    if(info.ssid || !info.truncated) {
+      setSsid(*net, info.ssid, info.ssidLen);
+      if(ssidHidden(info)) net->flags |= NET_HIDDEN; else net->flags &= ~NET_HIDDEN;
+    }
+    net->rssi = frame.rssi;
+    net->channel = info.channel ? info.channel : frame.channel;
+    net->flags |= NET_DETAILED;
+    net->beacons++;
+    if(info.truncated) {
+      mergeTruncated(*net, info);
+    } else {
+      net->security = info.security;
+      net->phy = info.phy;
+      net->country[0] = info.country ? info.country[0] : 0;
+      net->country[1] = info.country ? info.country[1] : 0;
+    }
+    noteChange(*net, before, inserted);
+    livePush(net->feedId, net->rssi, net->channel);
+    bssDirty = true;
+  }
+  halMutexUnlock(tableMutex);
+}
+
+void scannerTask(void*) {
+  uint8_t channel = 1;
+  uint32_t sweepStart = halMillis();
+  
+  for(;;) {
+    // Sweep a few channels per tick so every channel is refreshed continuously
+    for(int i = 0; i < CHANNELS_PER_TICK; i++) {
+      scanRunning = true;
+      uint32_t scanStart = halMillis();
+      int result = halScanChannel(channel, dwellPlanner.dwellFor(channel));
+      dwellMs[channel - 1].observe(halMillis() - scanStart);
+      scanRunning = false;
+  
+      if(result >= 0) {
+        channelScans++;
+        halMutexLock(tableMutex);
+        mergeChannelResults(result);
+        halMutexUnlock(tableMutex);
+        dwellPlanner.record(channel, result);
+      } else {
+        scanFailures++;
+      }
+      halScanRelease();
+      channel = channel % CHANNEL_COUNT + 1;
+  
+      // A sweep ends when the scanner wraps back to channel 1; its duration
+      // includes the gaps between ticks
+      if(channel == 1) {
+        uint32_t now = halMillis();
+        sweepMs.observe(now - sweepStart);
+        sweepStart = now;
+        sweeps++;
+      }
+    }
+  
+    halMutexLock(tableMutex);
+    expireStaleBss();
+    if(bssDirty) tryPublishSnapshot();
+    halMutexUnlock(tableMutex);
+    halDelay(SCAN_TICK_GAP_MS);
+  }
+}
+
+// The page is stored gzipped in flash and sent straight from there; repeat
+// visits revalidate with the content-hash ETag and get a 304
+void handleRoot(HttpConnection& conn, const HttpRequest& req) {
+  conn.addHeader("ETag", INDEX_HTML_ETAG);
+  conn.addHeader("Cache-Control", "no-cache");
+  const char* ifNoneMatch = req.header("If-None-Match");
+  if(ifNoneMatch && strcmp(ifNoneMatch, INDEX_HTML_ETAG) == 0) {
+    conn.send(304);
+    return;
+  }
+  
+  conn.addHeader("Content-Encoding", "gzip");
+  conn.send(200, "text/html", INDEX_HTML_GZ, INDEX_HTML_GZ_LEN);
+}
+
+// Times are relative to the snapshot, not to the request, so the same
+// generation always serializes to the same bytes
+const char* encLabel(const NetworkInfo& net) {
+  return net.flags & NET_DETAILED ? securityLabel(net.security) : getEncryptionType(net.encryption);
+}
+
+void writeNetworkJson(JsonWriter& w, const ScanSnapshot* snap, uint32_t i) {
+  const NetworkInfo& net = snap->networks[i];
+  uint32_t snapTime = snap->time;
+  bool hidden = net.flags & NET_HIDDEN;
+  bool detailed = net.flags & NET_DETAILED;
+  char bssid[18];
+  formatBssid(net.bssid, bssid);
+  
+  w.beginObject();
+  w.key("ssid");
+  if(hidden) w.string("[Hidden Network]"); else w.string(net.ssid, net.ssidLen);
+  w.key("rssi"); w.number((int32_t)snap->rssi[i]);
+  w.key("ch"); w.number((uint32_t)snap->channel[i]);
+  w.key("enc"); w.string(encLabel(net));
+  if(detailed) {
+    char suites[64];
+    formatCiphers(net.security.pairwise, suites, sizeof(suites));
+    w.key("cipher"); w.string(suites);
+    formatAkms(net.security.akm, suites, sizeof(suites));
+    w.key("akm"); w.string(suites);
+    w.key("phy"); w.string(phyLabel(net.phy));
+    w.key("cc"); w.string(net.country, net.country[0] ? 2 : 0);
+  }
+  w.key("bssid"); w.string(bssid, 17);
+  w.key("id"); w.number((uint32_t)net.feedId);
+  w.key("hidden"); w.boolean(hidden);
+  w.key("beacons"); w.number(net.beacons);
+  w.key("first_seen"); w.number(snapTime - net.firstSeen);
+  w.key("last_seen"); w.number(snapTime - snap->lastSeen[i]);
+  w.key("seen_count"); w.number(net.seenCount);
+  w.endObject();
+}
+
+// Removals published after `since` and up to the snapshot's generation.
+// Returns false if some of them were overwritten while being read.
+bool writeRemovedJson(JsonWriter& w, const ScanSnapshot* snap, uint32_t since) {
+  uint32_t head = tombstoneHead.load();
+  uint32_t start = head > TOMBSTONE_COUNT ? head - TOMBSTONE_COUNT : 0;
+  
+  w.beginArray();
+  for(uint32_t i = start; i < head; i++) {
+    const Tombstone& t = tombstones[i % TOMBSTONE_COUNT];
+    if(t.generation <= since || t.generation > snap->generation) continue;
+    char bssid[18];
+    formatBssid(t.bssid, bssid);
+    w.string(bssid, 17);
+  }
+  w.endArray();
+  return tombstoneFloor.load() <= since;
+}
+
+// Generations restart at every boot, so what a client hands back as
+// ?since= or Last-Event-ID is "<boot id>-<generation>", like the ETag
+uint32_t bootId = 0;
+char bootHex[9];
+
+void genToken(uint32_t generation, char* out, size_t size) {
+  snprintf(out, size, "%s-%lu", bootHex, (unsigned long)generation);
+}
+
+// The generation a client token names, or 0 (never diffable) if it comes
+// from another boot or is not a token at all
+uint32_t parseGenToken(const char* token) {
+  char* end;
+  unsigned long boot = strtoul(token, &end, 16);
+  if(end == token || *end != '-' || boot != bootId) return 0;
+  return strtoul(end + 1, nullptr, 10);
+}
+
+void writeScanJson(JsonWriter& w, const ScanSnapshot* snap, uint32_t since, bool full) {
+  w.beginObject();
+  w.key("boot"); w.string(bootHex, 8);
+  w.key("gen"); w.number(snap->generation);
+  w.key("full"); w.boolean(full);
+  w.key("networks");
+  w.beginArray();
+  for(uint32_t i = 0; i < snap->count; i++) {
+    if(!full && snap->networks[i].changedGen <= since) continue;
+    writeNetworkJson(w, snap, i);
+  }
+  w.endArray();
+  if(!full) {
+    w.key("removed");
+    // A removal overwritten mid-response cannot be reported; ask for a full list
+    if(!writeRemovedJson(w, snap, since)) {
+      w.key("resync"); w.boolean(true);
+    }
+  }
+  w.endObject();
+}
+
+// A generation's full /scan body, serialized once on first request and sent
+// as-is to every reader until a newer generation replaces it. The reference
+// count keeps a body alive while connections are still sending it, even
+// after the cache has moved on.
+SharedBody* cachedScan = nullptr;
+
+// Renders a /scan body. Returns it with one reference held by the caller,
+// or nullptr if it could not be allocated.
+SharedBody* renderScan(const ScanSnapshot* snap, uint32_t since, bool full) {
+  SharedBody* body = sharedBodyNew(snap->generation);
+  if(!body) return nullptr;
+  
+  char buf[JSON_CHUNK_SIZE];
+  JsonWriter w(buf, sizeof(buf), sharedBodySink, body);
+  writeScanJson(w, snap, since, full);
+  w.flush();
+  
+  if(body->failed) {
+    sharedBodyRelease(body);
+    return nullptr;
+  }
+  return body;
+}
+
+// Returns a retained full body for the snapshot's generation
+SharedBody* serializedScanFor(const ScanSnapshot* snap) {
+  if(!cachedScan || cachedScan->tag != snap->generation) {
+    SharedBody* body = renderScan(snap, 0, true);
+    if(!body) return nullptr;
+    if(cachedScan) sharedBodyRelease(cachedScan);
+    cachedScan = body;
+  }
+  
+  return sharedBodyRetain(cachedScan);
+}
+
+// Strong per-generation tag; the boot id keeps tags from before a reboot
+// from matching a new generation with the same number
+void scanEtag(uint32_t generation, char* out, size_t size) {
+  snprintf(out, size, "\"%s-%lu\"", bootHex, (unsigned long)generation);
+}
+
+bool canDiffFrom(const ScanSnapshot* snap, uint32_t since) {
+  return since != 0 && since <= snap->generation && tombstoneFloor.load() <= since;
+}
+
+// A delta that would carry more than RENDER_MAX_NETWORKS records is sent as
+// the generation's shared full body instead, so no per-request body grows
+// with the table
+bool needsFullScan(const ScanSnapshot* snap, uint32_t since) {
+  if(!canDiffFrom(snap, since)) return true;
+  uint32_t changed = 0;
+  for(uint32_t i = 0; i < snap->count; i++) {
+    if(snap->networks[i].changedGen > since && ++changed > RENDER_MAX_NETWORKS) return true;
+  }
+  return false;
+}
+
+// Filtered, sorted and paged listing for /scan?sort=...&min_rssi=...
+struct ScanView {
+  int sort;             // SORT_* or -1 for table order
+  int minRssi;
+  int channel;          // 0 matches any
+  int hidden;           // -1 matches either
+  char enc[24];         // "" matches any
+  uint32_t offset;
+  uint32_t limit;
+};
+
+// Fills `view` from the query. Returns false if no view parameter was given;
+// sets `valid` to false on an unknown sort key.
+bool parseView(const HttpRequest& req, ScanView& view, bool& valid) {
+  static const char* const params[] = { "sort", "min_rssi", "channel", "enc", "hidden", "limit", "offset" };
+  bool any = false;
+  for(const char* param : params) any |= req.hasArg(param);
+  valid = true;
+  if(!any) return false;
+  
+  char arg[24];
+  view.sort = -1;
+  if(req.arg("sort", arg, sizeof(arg))) {
+    if(strcmp(arg, "rssi") == 0) view.sort = SORT_RSSI;
+    else if(strcmp(arg, "channel") == 0) view.sort = SORT_CHANNEL;
+    else if(strcmp(arg, "ssid") == 0) view.sort = SORT_SSID;
+    else if(strcmp(arg, "last_seen") == 0) view.sort = SORT_LAST_SEEN;
+    else valid = false;
+  }
+  view.minRssi = req.arg("min_rssi", arg, sizeof(arg)) ? atoi(arg) : -128;
+  view.channel = req.arg("channel", arg, sizeof(arg)) ? atoi(arg) : 0;
+  view.hidden = req.arg("hidden", arg, sizeof(arg)) ? atoi(arg) != 0 : -1;
+  if(!req.arg("enc", view.enc, sizeof(view.enc))) view.enc[0] = 0;
+  view.offset = req.arg("offset", arg, sizeof(arg)) ? strtoul(arg, nullptr, 10) : 0;
+  view.limit = req.arg("limit", arg, sizeof(arg)) ? strtoul(arg, nullptr, 10) : RENDER_MAX_NETWORKS;
+  if(view.limit > RENDER_MAX_NETWORKS) view.limit = RENDER_MAX_NETWORKS;
+  return true;
+}
+
+// Orders snapshot indexes by one key; ties fall back to the index so every
+// order is total and stable across rebuilds
+struct OrderLess {
+  const ScanSnapshot* snap;
+  int key;
+  
+  bool operator()(uint16_t a, uint16_t b) const {
+    switch(key) {
+      case SORT_RSSI:
+        if(snap->rssi[a] != snap->rssi[b]) return snap->rssi[a] > snap->rssi[b];
+        break;
+      case SORT_CHANNEL:
+        if(snap->channel[a] != snap->channel[b]) return snap->channel[a] < snap->channel[b];
+        if(snap->rssi[a] != snap->rssi[b]) return snap->rssi[a] > snap->rssi[b];
+        break;
+      case SORT_SSID: {
+        const NetworkInfo& x = snap->networks[a];
+        const NetworkInfo& y = snap->networks[b];
+        int c = memcmp(x.ssid, y.ssid, std::min(x.ssidLen, y.ssidLen));
+        if(c != 0) return c < 0;
+        if(x.ssidLen != y.ssidLen) return x.ssidLen < y.ssidLen;
+        break;
+      }
+      case SORT_LAST_SEEN:
+        if(snap->lastSeen[a] != snap->lastSeen[b]) return (int32_t)(snap->lastSeen[a] - snap->lastSeen[b]) > 0;
+        break;
+    }
+    return a < b;
+  }
+};
+
+// Insertion sort for an almost-sorted permutation. Gives up, leaving a
+// valid permutation, once it has moved `budget` elements.
+bool insertionSort(uint16_t* order, uint32_t count, const OrderLess& less, uint32_t budget) {
+  for(uint32_t i = 1; i < count; i++) {
+    uint16_t index = order[i];
+    uint32_t j = i;
+    while(j > 0 && less(index, order[j - 1])) {
+      order[j] = order[j - 1];
+      j--;
+      if(--budget == 0) {
+        order[j] = index;
+        return false;
+      }
+    }
+    order[j] = index;
+  }
+  return true;
+}
+
+// Returns the snapshot's permutation for `key`, building it if this
+// generation has not been sorted that way yet. Each buffer keeps its last
+// permutation: when no record has moved since (same table layout), it is
+// extended with the new indexes and re-sorted by insertion, which is close
+// to linear because RSSI and last-seen orders change little between
+// generations. Anything else gets a full sort.
+const uint16_t* sortOrder(ScanSnapshot* snap, int key) {
+  uint32_t count = snap->count;
+  if(snap->orderGeneration[key] == snap->generation && snap->orderCount[key] == count) return snap->order[key];
+  
+  if(snap->orderCapacity[key] < count) {
+    uint32_t capacity = snap->capacity;
+    uint16_t* grown = (uint16_t*)psramRealloc(snap->order[key], sizeof(uint16_t) * capacity);
+    if(!grown) return nullptr;
+    snap->order[key] = grown;
+    snap->orderCapacity[key] = capacity;
+    snap->orderGeneration[key] = 0;
+  }
+  
+  uint16_t* order = snap->order[key];
+  OrderLess less = { snap, key };
+  bool extend = snap->orderGeneration[key] != 0 && snap->orderLayout[key] == snap->tableLayout && snap->orderCount[key] <= count;
+  uint32_t from = extend ? snap->orderCount[key] : 0;
+  for(uint32_t i = from; i < count; i++) order[i] = i;
+  if(!extend || !insertionSort(order, count, less, count * SORT_INSERTION_BUDGET)) std::sort(order, order + count, less);
+  
+  snap->orderCount[key] = count;
+  snap->orderLayout[key] = snap->tableLayout;
+  snap->orderGeneration[key] = snap->generation;
+  return order;
+}
+
+bool viewMatches(const ScanSnapshot* snap, uint32_t i, const ScanView& view) {
+  if(snap->rssi[i] < view.minRssi) return false;
+  if(view.channel && snap->channel[i] != view.channel) return false;
+  const NetworkInfo& net = snap->networks[i];
+  if(view.hidden >= 0 && ((net.flags & NET_HIDDEN) != 0) != (view.hidden != 0)) return false;
+  if(view.enc[0] && strcasecmp(encLabel(net), view.enc) != 0) return false;
+  return true;
+}
+
+void writeViewJson(JsonWriter& w, const ScanSnapshot* snap, const uint16_t* order, const ScanView& view) {
+  uint32_t matched = 0;
+  w.beginObject();
+  w.key("boot"); w.string(bootHex, 8);
+  w.key("gen"); w.number(snap->generation);
+  w.key("full"); w.boolean(true);
+  w.key("offset"); w.number(view.offset);
+  w.key("limit"); w.number(view.limit);
+  w.key("networks");
+  w.beginArray();
+  for(uint32_t n = 0; n < snap->count; n++) {
+    uint32_t i = order ? order[n] : n;
+    if(!viewMatches(snap, i, view)) continue;
+    if(matched >= view.offset && matched - view.offset < view.limit) writeNetworkJson(w, snap, i);
+    matched++;
+  }
+  w.endArray();
+  w.key("total"); w.number(matched);
+  w.endObject();
+}
+
+// Deltas and views rendered for recent generations. Clients polling the
+// same thing around the same time share one body instead of each holding
+// their own; a slot is only taken from the current generation when every
+// other slot is in use by it.
+struct RenderedBody {
+  uint32_t generation;
+  uint32_t since;       // delta base, or 0 for a view
+  ScanView view;
+  SharedBody* body;
+};
+
+const ScanView noView = { -1, -128, 0, -1, "", 0, 0 };
+RenderedBody rendered[RENDER_CACHE_SLOTS];
+uint8_t renderedNext = 0;
+
+bool sameView(const ScanView& a, const ScanView& b) {
+  return a.sort == b.sort && a.minRssi == b.minRssi && a.channel == b.channel && a.hidden == b.hidden &&
+    strcmp(a.enc, b.enc) == 0 && a.offset == b.offset && a.limit == b.limit;
+}
+
+SharedBody* findRendered(uint32_t generation, uint32_t since, const ScanView& view) {
+  for(RenderedBody& r : rendered) {
+    if(r.body && r.generation == generation && r.since == since && sameView(r.view, view)) return sharedBodyRetain(r.body);
+  }
+  return nullptr;
+}
+
+void keepRendered(uint32_t generation, uint32_t since, const ScanView& view, SharedBody* body) {
+  RenderedBody* slot = nullptr;
+  for(RenderedBody& r : rendered) {
+    if(!r.body || r.generation != generation) {
+      slot = &r;
+      break;
+    }
+  }
+  if(!slot) slot = &rendered[renderedNext++ % RENDER_CACHE_SLOTS];
+  
+  if(slot->body) sharedBodyRelease(slot->body);
+  slot->generation = generation;
+  slot->since = since;
+  slot->view = view;
+  slot->body = sharedBodyRetain(body);
+}
+
+// Body that brings a client at `since` up to the snapshot: the shared full
+// body if `full`, else a delta rendered once per base generation
+SharedBody* scanBody(const ScanSnapshot* snap, uint32_t since, bool full) {
+  if(full) return serializedScanFor(snap);
+  
+  SharedBody* body = findRendered(snap->generation, since, noView);
+  if(body) return body;
+  body = renderScan(snap, since, false);
+  if(body) keepRendered(snap->generation, since, noView, body);
+  return body;
+}
+
+// Views are rendered from the pinned snapshot at most once per generation;
+// no sweep is started and the sort permutation is shared by every view of
+// the same generation. Pages hold at most RENDER_MAX_NETWORKS records.
+void sendView(HttpConnection& conn, ScanSnapshot* snap, const ScanView& view) {
+  SharedBody* body = findRendered(snap->generation, 0, view);
+  if(!body) {
+    const uint16_t* order = view.sort >= 0 ? sortOrder(snap, view.sort) : nullptr;
+    body = view.sort < 0 || order ? sharedBodyNew(snap->generation) : nullptr;
+    if(body) {
+      char buf[JSON_CHUNK_SIZE];
+      JsonWriter w(buf, sizeof(buf), sharedBodySink, body);
+      writeViewJson(w, snap, order, view);
+      w.flush();
+      if(!body->failed) keepRendered(snap->generation, 0, view, body);
+    }
+  }
+  releaseSnapshot(snap);
+  
+  if(!body || body->failed) {
+    conn.send(503, "text/plain", "Out of memory");
+  } else {
+    conn.send(200, "application/json", body);
+  }
+  if(body) sharedBodyRelease(body);
+}
+
+void handleScan(HttpConnection& conn, const HttpRequest& req) {
+  ScanView view;
+  bool valid;
+  bool filtered = parseView(req, view, valid);
+  if(!valid) {
+    conn.send(400, "text/plain", "sort must be rssi, channel, ssid or last_seen");
+    return;
+  }
+  
+  ScanSnapshot* snap = acquireSnapshot();
+  
+  // Per-request state goes in headers so full bodies stay cacheable
+  char age[12];
+  snprintf(age, sizeof(age), "%ld", snap->generation == 0 ? -1L : (long)(halMillis() - snap->time));
+  conn.addHeader("X-Scan-Age", age);
+  conn.addHeader("X-Scanning", scanRunning ? "1" : "0");
+  if(filtered) {
+    sendView(conn, snap, view);
+    return;
+  }
+  
+  // ?since=<boot>-<gen> returns only what was added, changed or removed
+  // after that generation; anything the server can no longer diff, or a
+  // token from another boot, gets a full list
+  char arg[24];
+  uint32_t since = req.arg("since", arg, sizeof(arg)) ? parseGenToken(arg) : 0;
+  bool full = needsFullScan(snap, since);
+  
+  if(full && snap->generation != 0) {
+    char etag[24];
+    scanEtag(snap->generation, etag, sizeof(etag));
+    conn.addHeader("ETag", etag);
+    conn.addHeader("Cache-Control", "no-cache");
+    const char* ifNoneMatch = req.header("If-None-Match");
+    if(ifNoneMatch && strcmp(ifNoneMatch, etag) == 0) {
+      releaseSnapshot(snap);
+      conn.send(304);
+      return;
+    }
+  }
+  SharedBody* body = scanBody(snap, since, full);
+  releaseSnapshot(snap);
+  
+  if(!body) {
+    conn.send(503, "text/plain", "Out of memory");
+    return;
+  }
+  conn.send(200, "application/json", body);
+  sharedBodyRelease(body);
+}
+
+// Server-Sent Events: subscribers get the full table when they connect and
+// then one delta per published generation, rendered once and queued on
+// every subscriber. A subscriber that falls too far behind is closed once
+// its backlog drains; the browser reconnects with Last-Event-ID and catches
+// up from there.
+uint32_t eventGeneration = 0;
+unsigned long lastEventPush = 0;
+unsigned long lastKeepalive = 0;
+
+// Event framing goes around the JSON body in its own segments, so a full
+// table is the generation's shared body rather than a framed copy of it
+SharedBody* eventPrefix(uint32_t generation) {
+  char token[24];
+  genToken(generation, token, sizeof(token));
+  char prefix[48];
+  int len = snprintf(prefix, sizeof(prefix), "id: %s\nevent: scan\ndata: ", token);
+  SharedBody* body = sharedBodyNew(generation);
+  if(body) sharedBodyAppend(body, prefix, len);
+  if(body && body->failed) {
+    sharedBodyRelease(body);
+    return nullptr;
+  }
+  return body;
+}
+
+// The browser dispatches an event only once its blank line arrives, so one
+// queued in part is simply lost with the connection
+bool writeScanEvent(HttpConnection& conn, SharedBody* prefix, SharedBody* json) {
+  return conn.write(prefix) && conn.write(json) && conn.write("\n\n", 2);
+}
+
+void handleEvents(HttpConnection& conn, const HttpRequest& req) {
+  if(server.streamCount(STREAM_EVENTS) >= SSE_MAX_CLIENTS) {
+    conn.send(503, "text/plain", "Too many event subscribers");
+    return;
+  }
+  
+  // A reconnecting browser sends the last generation it applied
+  ScanSnapshot* snap = acquireSnapshot();
+  const char* lastId = req.header("Last-Event-ID");
+  uint32_t since = lastId ? parseGenToken(lastId) : 0;
+  SharedBody* body = snap->generation != 0 ? scanBody(snap, since, needsFullScan(snap, since)) : nullptr;
+  SharedBody* prefix = body ? eventPrefix(snap->generation) : nullptr;
+  releaseSnapshot(snap);
+  
+  conn.beginEventStream(STREAM_EVENTS);
+  conn.write("retry: 2000\n\n", 13);
+  if(body && prefix) writeScanEvent(conn, prefix, body);
+  if(body) sharedBodyRelease(body);
+  if(prefix) sharedBodyRelease(prefix);
+}
+
+void pumpEvents() {
+  unsigned long now = halMillis();
+  if(server.streamCount(STREAM_EVENTS) == 0) {
+    eventGeneration = frontSnapshot.load()->generation;
+    return;
+  }
+  
+  bool ping = now - lastKeepalive >= SSE_KEEPALIVE_MS;
+  if(ping) lastKeepalive = now;
+  
+  // Every subscriber has applied eventGeneration (newer ones got a full table
+  // on connect), so one delta from there serves them all, however large
+  SharedBody* body = nullptr;
+  SharedBody* prefix = nullptr;
+  if(now - lastEventPush >= SSE_MIN_INTERVAL_MS) {
+    ScanSnapshot* snap = acquireSnapshot();
+    if(snap->generation != eventGeneration) {
+      body = scanBody(snap, eventGeneration, !canDiffFrom(snap, eventGeneration));
+      prefix = body ? eventPrefix(snap->generation) : nullptr;
+    }
+    releaseSnapshot(snap);
+    if(body && !prefix) {
+      sharedBodyRelease(body);
+      body = nullptr;
+    }
+    if(body) {
+      eventGeneration = body->tag;
+      lastEventPush = now;
+    }
+  }
+  if(!body && !ping) return;
+  
+  for(int i = 0; i < server.connectionCount(); i++) {
+    HttpConnection& conn = server.connection(i);
+    if(conn.stream() != STREAM_EVENTS || conn.closing()) continue;
+    // Skipping an event would leave a gap in the deltas, so a subscriber
+    // that cannot take it gets what is queued and then a reconnect
+    if(body && (conn.pending() > SSE_BACKLOG_MAX || !writeScanEvent(conn, prefix, body))) {
+      conn.close();
+      eventsDropped++;
+      continue;
+    }
+    if(ping) conn.write(": ping\n\n", 8);
+  }
+  if(body) {
+    sharedBodyRelease(body);
+    sharedBodyRelease(prefix);
+  }
+}
+
+// Binary WebSocket feed of RSSI samples (see live_feed.h). Each tick the
+// queued samples are framed once and queued on every subscriber that has
+// finished sending the previous frame. A slow phone skips frames and only
+// loses its own samples; nothing upstream ever waits for it.
+// Beacon capture is what makes the feed fast (every beacon is a sample), so
+// it runs for as long as anyone is subscribed, even if the browser goes
+// away without saying so.
+unsigned long lastLivePush = 0;
+uint32_t liveSkipped = 0;
+
+// Two independent demands keep beacon capture on: an explicit
+// /capture?enable=1 and any open /live subscriber. Neither can switch it
+// off under the other.
+bool captureRequested = false;
+int liveSubscribers = 0;
+
+void updateCapture() {
+  captureEnable(captureRequested || liveSubscribers > 0);
+}
+
+void handleLive(HttpConnection& conn, const HttpRequest& req) {
+  if(server.streamCount(STREAM_LIVE) >= LIVE_MAX_CLIENTS) {
+    conn.send(503, "text/plain", "Too many live subscribers");
+    return;
+  }
+  if(conn.acceptWebSocket(req, STREAM_LIVE)) {
+    liveSetActive(true);
+    liveSubscribers = server.streamCount(STREAM_LIVE);
+    updateCapture();
+  }
+}
+
+void pumpLive() {
+  liveSubscribers = server.streamCount(STREAM_LIVE);
+  updateCapture();
+  if(liveSubscribers == 0) {
+    liveSetActive(false);
+    return;
+  }
+  
+  unsigned long now = halMillis();
+  if(now - lastLivePush < LIVE_INTERVAL_MS) return;
+  lastLivePush = now;
+  
+  uint8_t payload[LIVE_PAYLOAD_MAX];
+  size_t payloadLen = liveEncode(payload, now);
+  if(payloadLen == 0) return;
+  
+  SharedBody* frame = sharedBodyNew(0);
+  if(!frame) return;
+  uint8_t header[WS_HEADER_MAX];
+  sharedBodyAppend(frame, header, wsFrameHeader(header, WS_OP_BINARY, payloadLen));
+  sharedBodyAppend(frame, payload, payloadLen);
+  
+  for(int i = 0; i < server.connectionCount() && !frame->failed; i++) {
+    HttpConnection& conn = server.connection(i);
+    if(conn.stream() != STREAM_LIVE || conn.closing()) continue;
+    if(conn.pending() > 0) {
+      liveSkipped++;
+      continue;
+    }
+    conn.write(frame);
+  }
+  sharedBodyRelease(frame);
+}
+
+void handleCapture(HttpConnection& conn, const HttpRequest& req) {
+  char enable[4];
+  if(req.arg("enable", enable, sizeof(enable))) {
+    captureRequested = strcmp(enable, "1") == 0;
+    updateCapture();
+  }
+  
+  CaptureStats stats = captureStats();
+  char json[192];
+  int len = snprintf(json, sizeof(json), "{\"enabled\":%s,\"requested\":%s,\"live\":%d,\"captured\":%u,\"parsed\":%u,\"malformed\":%u,\"dropped\":%u}",
+                     captureEnabled() ? "true" : "false", captureRequested ? "true" : "false", liveSubscribers,
+                     (unsigned)stats.captured, (unsigned)stats.parsed,
+                     (unsigned)stats.malformed, (unsigned)stats.dropped);
+  
+  conn.sendCopy(200, "application/json", json, len);
+}
+
+// Prometheus scrape target. Per-route histograms are indexed by route, with
+// one extra slot for requests that matched none; all of them are written by
+// the HTTP task from observeResponse().
+LogHistogram handlerUs[HTTP_MAX_ROUTES + 1];
+LogHistogram responseUs[HTTP_MAX_ROUTES + 1];
+LogHistogram responseBytes[HTTP_MAX_ROUTES + 1];
+
+void observeResponse(int route, uint32_t handler, uint32_t total, uint32_t bytes) {
+  int slot = route < 0 ? HTTP_MAX_ROUTES : route;
+  handlerUs[slot].observe(handler);
+  responseUs[slot].observe(total);
+  responseBytes[slot].observe(bytes);
+}
+
+void writeRouteHistograms(SharedBody* out, const char* name, const char* help, LogHistogram* histograms, double scale) {
+  char labels[48];
+  metricsHeader(out, name, "histogram", help);
+  for(int i = 0; i <= server.registeredRoutes(); i++) {
+    int slot = i < server.registeredRoutes() ? i : HTTP_MAX_ROUTES;
+    // Routes never requested stay out of the scrape until they are
+    if(histograms[slot].count() == 0) continue;
+    snprintf(labels, sizeof(labels), "route=\"%s\"", slot < HTTP_MAX_ROUTES ? server.routePath(slot) : "other");
+    histograms[slot].write(out, name, labels, scale);
+  }
+}
+
+void writeCounter(SharedBody* out, const char* name, const char* help, uint64_t value) {
+  metricsHeader(out, name, "counter", help);
+  metricsValue(out, name, "", value);
+}
+
+void writeGauge(SharedBody* out, const char* name, const char* help, uint64_t value) {
+  metricsHeader(out, name, "gauge", help);
+  metricsValue(out, name, "", value);
+}
+
+void handleMetrics(HttpConnection& conn, const HttpRequest& req) {
+  (void)req;
+  SharedBody* body = sharedBodyNew(0);
+  if(!body) {
+    conn.send(503, "text/plain", "Out of memory");
+    return;
+  }
+  
+  halMutexLock(tableMutex);
+  uint32_t tableSize = bssTable.size();
+  uint32_t evicted = bssTable.evictions();
+  uint32_t expired = bssExpired;
+  halMutexUnlock(tableMutex);
+  HalHeapInfo heap;
+  halHeapInfo(heap);
+  CaptureStats capture = captureStats();
+  char labels[24];
+  
+  metricsHeader(body, "analyzer_sweep_duration_seconds", "histogram", "Time to scan every channel once");
+  sweepMs.write(body, "analyzer_sweep_duration_seconds", "", 1e-3);
+  metricsHeader(body, "analyzer_channel_dwell_seconds", "histogram", "Time spent scanning one channel");
+  for(int c = 0; c < CHANNEL_COUNT; c++) {
+    snprintf(labels, sizeof(labels), "channel=\"%d\"", c + 1);
+    dwellMs[c].write(body, "analyzer_channel_dwell_seconds", labels, 1e-3);
+  }
+  writeRouteHistograms(body, "analyzer_http_handler_seconds", "Time spent in the route handler", handlerUs, 1e-6);
+  writeRouteHistograms(body, "analyzer_http_response_seconds", "Time from request parsed to response fully sent", responseUs, 1e-6);
+  writeRouteHistograms(body, "analyzer_http_response_bytes", "Response size including headers", responseBytes, 1);
+  
+  writeCounter(body, "analyzer_channel_scans_total", "Channel scans completed", channelScans.load());
+  writeCounter(body, "analyzer_scan_failures_total", "Channel scans that failed to start", scanFailures.load());
+  writeCounter(body, "analyzer_sweeps_total", "Sweeps over every channel", sweeps.load());
+  writeCounter(body, "analyzer_bss_evictions_total", "Networks evicted from a full table", evicted);
+  writeCounter(body, "analyzer_bss_expired_total", "Networks expired after not being seen", expired);
+  metricsHeader(body, "analyzer_dropped_total", "counter", "Data dropped because a consumer fell behind");
+  metricsValue(body, "analyzer_dropped_total", "source=\"capture_frames\"", capture.dropped);
+  metricsValue(body, "analyzer_dropped_total", "source=\"live_samples\"", liveDropped());
+  metricsValue(body, "analyzer_dropped_total", "source=\"live_frames\"", liveSkipped);
+  metricsValue(body, "analyzer_dropped_total", "source=\"event_subscribers\"", eventsDropped);
+  
+  metricsHeader(body, "analyzer_heap_free_bytes", "gauge", "Free heap");
+  metricsValue(body, "analyzer_heap_free_bytes", "region=\"internal\"", heap.internalFree);
+  metricsValue(body, "analyzer_heap_free_bytes", "region=\"psram\"", heap.psramFree);
+  metricsHeader(body, "analyzer_heap_largest_free_block_bytes", "gauge", "Largest block a single allocation can get");
+  metricsValue(body, "analyzer_heap_largest_free_block_bytes", "region=\"internal\"", heap.internalLargest);
+  metricsValue(body, "analyzer_heap_largest_free_block_bytes", "region=\"psram\"", heap.psramLargest);
+  writeGauge(body, "analyzer_psram_allocated_bytes", "Bytes held through psramAlloc", psramStats().liveBytes);
+  writeGauge(body, "analyzer_bss_table_size", "Networks in the BSS table", tableSize);
+  writeGauge(body, "analyzer_scan_generation", "Last published scan generation", scanGeneration.load());
+  
+  if(body->failed) {
+    conn.send(503, "text/plain", "Out of memory");
+  } else {
+    conn.send(200, "text/plain; version=0.0.4", body);
+  }
+  sharedBodyRelease(body);
+}
+
+void analyzerCoreBegin() {
+  tableMutex = halMutexCreate();
+  bssTable.begin(BSS_TABLE_INITIAL, BSS_TABLE_MAX);
+  bssTable.onEvict(recordRemoval);
+}
+
+bool analyzerBegin(uint16_t port) {
+  bootId = halRandom();
+  snprintf(bootHex, sizeof(bootHex), "%08lx", (unsigned long)bootId);
+  
+  server.on("/", handleRoot);
+  server.on("/scan", handleScan);
+  server.on("/events", handleEvents);
+  server.on("/live", handleLive);
+  server.on("/capture", handleCapture);
+  server.on("/metrics", handleMetrics);
+  server.onResponse(observeResponse);
+  if(!server.begin(port)) return false;
+  
+  analyzerCoreBegin();
+  captureBegin(onBeacon);
+  
+  // Scanning runs on core 0 so the web server on the loop() core never waits on the radio
+  halTaskCreate(scannerTask, "scanner", SCANNER_STACK, SCANNER_PRIORITY, SCANNER_CORE);
+  return true;
+}
+
+void analyzerLoop() {
+  server.poll(HTTP_POLL_MS);
+  pumpEvents();
+  pumpLive();
+}
+
+void analyzerMerge(const ScanResult* results, int count) {
+  halMutexLock(tableMutex);
+  for(int i = 0; i < count; i++) mergeScanResult(results[i]);
+  if(count > 0) bssDirty = true;
+  halMutexUnlock(tableMutex);
+}
+
+uint32_t analyzerPublish() {
+  halMutexLock(tableMutex);
+  expireStaleBss();
+  if(bssDirty) tryPublishSnapshot();
+  halMutexUnlock(tableMutex);
+  return frontSnapshot.load()->count;
+}
+
+bool analyzerSort(int key, bool rebuild) {
+  ScanSnapshot* snap = acquireSnapshot();
+  if(rebuild) snap->orderGeneration[key] = 0;
+  bool sorted = sortOrder(snap, key) != nullptr;
+  releaseSnapshot(snap);
+  return sorted;
+}
+
+size_t analyzerRenderScan() {
+  ScanSnapshot* snap = acquireSnapshot();
+  SharedBody* body = renderScan(snap, 0, true);
+  releaseSnapshot(snap);
+  if(!body) return 0;
+  
+  size_t len = body->len;
+  sharedBodyRelease(body);
+  return len;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "hal.h"
+
+#define SORT_RSSI 0
+#define SORT_CHANNEL 1
+#define SORT_SSID 2
+#define SORT_LAST_SEEN 3
+#define SORT_KEYS 4
+
+// The analyzer core: BSS table, scanner task and HTTP endpoints, written
+// against hal.h only. The platform entry point brings up the radio and
+// network, then calls analyzerBegin() once and analyzerLoop() forever.
+
+// Returns false if the HTTP port could not be opened
+bool analyzerBegin(uint16_t port);
+void analyzerLoop();
+
+// The pipeline one stage at a time, without the HTTP server or any tasks,
+// for bench/bench_core.cpp. Call analyzerCoreBegin() instead of
+// analyzerBegin() and drive everything from one thread.
+void analyzerCoreBegin();
+// Merges one channel's results into the table, like the scanner does
+void analyzerMerge(const ScanResult* results, int count);
+// Expires and publishes a snapshot; returns the networks it holds
+uint32_t analyzerPublish();
+// Sorts the published snapshot by a SORT_* key. `rebuild` discards the
+// cached permutation so it is sorted from scratch.
+bool analyzerSort(int key, bool rebuild);
+// Serializes the full /scan body of the published snapshot; returns bytes
+size_t analyzerRenderScan();
@@ -0,0 +1,158 @@
+#include "bss_table.h"
+
+bool BssTable::begin(uint32_t initialCapacity, uint32_t maxEntriesLimit) {
+  maxEntries = maxEntriesLimit;
+  capacity = 0;
+  count = 0;
+  
+  uint32_t target = initialCapacity < maxEntries ? initialCapacity : maxEntries;
+  while(capacity < target) {
+    if(!grow()) return false;
+  }
+  return growSlots(capacity);
+}
+
+uint32_t BssTable::slotFor(uint64_t key) const {
+  return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & slotMask;
+}
+
+uint32_t BssTable::findIndex(uint64_t key) const {
+  for(uint32_t s = slotFor(key);; s = (s + 1) & slotMask) {
+    uint32_t slot = slots[s];
+    if(slot == 0) return NONE;
+    if(entries[slot - 1].key == key) return slot - 1;
+  }
+}
+
+// Slots are sized for the new capacity first, so the load factor bound
+// holds even if the record array then fails to grow
+bool BssTable::grow() {
+  uint32_t newCapacity = capacity ? capacity * 2 : 16;
+  if(newCapacity > maxEntries) newCapacity = maxEntries;
+  if(newCapacity <= capacity) return false;
+  return growSlots(newCapacity) && growEntries(newCapacity);
+}
+
+bool BssTable::growEntries(uint32_t newCapacity) {
+  Entry* grown = (Entry*)psramAlloc(sizeof(Entry) * newCapacity);
+  if(!grown) return false;
+  
+  if(count) memcpy(grown, entries, sizeof(Entry) * count);
+  psramFree(entries);
+  entries = grown;
+  capacity = newCapacity;
+  return true;
+}
+
+// Keeps the load factor at or below 1/2 for short probe sequences
+bool BssTable::growSlots(uint32_t forCapacity) {
+  uint32_t slotCount = 16;
+  while(slotCount < forCapacity * 2) slotCount *= 2;
+  if(slots && slotCount <= slotMask + 1) return true;
+  
+  uint32_t* grown = (uint32_t*)psramAlloc(sizeof(uint32_t) * slotCount);
+  if(!grown) return false;
+  memset(grown, 0, sizeof(uint32_t) * slotCount);
+  
+  psramFree(slots);
+  slots = grown;
+  slotMask = slotCount - 1;
+  for(uint32_t i = 0; i < count; i++) insertSlot(entries[i].key, i);
+  return true;
+}
+
+void BssTable::insertSlot(uint64_t key, uint32_t index) {
+  uint32_t s = slotFor(key);
+  while(slots[s] != 0) s = (s + 1) & slotMask;
+  slots[s] = index + 1;
+}
+
+// Linear probing delete with backward shift, so no tombstones accumulate
+void BssTable::eraseSlot(uint64_t key) {
+  uint32_t s = slotFor(key);
+  while(entries[slots[s] - 1].key != key) s = (s + 1) & slotMask;
+  
+  uint32_t hole = s;
+  for(uint32_t next = (s + 1) & slotMask; slots[next] != 0; next = (next + 1) & slotMask) {
+    uint32_t home = slotFor(entries[slots[next] - 1].key);
+    // Move the entry back if its home is not cyclically within (hole, next]
+    bool movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+    if(movable) {
+      slots[hole] = slots[next];
+      hole = next;
+    }
+  }
+  slots[hole] = 0;
+}
+
+void BssTable::lruUnlink(uint32_t index) {
+  Entry& e = entries[index];
+  if(e.lruPrev != NONE) entries[e.lruPrev].lruNext = e.lruNext; else lruHead = e.lruNext;
+  if(e.lruNext != NONE) entries[e.lruNext].lruPrev = e.lruPrev; else lruTail = e.lruPrev;
+}
+
+void BssTable::lruPushFront(uint32_t index) {
+  Entry& e = entries[index];
+  e.lruPrev = NONE;
+  e.lruNext = lruHead;
+  if(lruHead != NONE) entries[lruHead].lruPrev = index;
+  lruHead = index;
+  if(lruTail == NONE) lruTail = index;
+}
+
+NetworkInfo* BssTable::find(const uint8_t* bssid) {
+  uint32_t index = findIndex(bssidKey(bssid));
+  return index == NONE ? nullptr : &entries[index].info;
+}
+
+NetworkInfo* BssTable::upsert(const uint8_t* bssid, bool* inserted) {
+  uint64_t key = bssidKey(bssid);
+  uint32_t index = findIndex(key);
+  
+  if(index != NONE) {
+    lruUnlink(index);
+    if(inserted) *inserted = false;
+  } else {
+    if(count == capacity && !grow()) {
+      if(lruTail == NONE) return nullptr;
+      if(evictHandler) evictHandler(entries[lruTail].info);
+      removeAt(lruTail);
+      evicted++;
+    }
+    
+    index = count++;
+    memset(&entries[index], 0, sizeof(Entry));
+    entries[index].key = key;
+    insertSlot(key, index);
+    if(inserted) *inserted = true;
+  }
+  
+  lruPushFront(index);
+  entries[index].touched = ++touchCounter;
+  return &entries[index].info;
+}
+
+// Swap-remove keeps the record array dense; the moved entry's slot and LRU
+// links are repointed at its new index
+void BssTable::removeAt(uint32_t index) {
+  eraseSlot(entries[index].key);
+  lruUnlink(index);
+  layoutVersion++;
+  
+  uint32_t last = --count;
+  if(index != last) {
+    Entry& moved = entries[last];
+    entries[index] = moved;
+    
+    uint32_t s = slotFor(moved.key);
+    while(slots[s] != last + 1) s = (s + 1) & slotMask;
+    slots[s] = index + 1;
+    
+    if(moved.lruPrev != NONE) entries[moved.lruPrev].lruNext = index; else lruHead = index;
+    if(moved.lruNext != NONE) entries[moved.lruNext].lruPrev = index; else lruTail = index;
+  }
+}
+
+size_t BssTable::memoryUsed() const {
+  return sizeof(Entry) * capacity + sizeof(uint32_t) * (slotMask + 1);
+}
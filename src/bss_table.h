@@ -0,0 +1,81 @@
+#pragma once
+#include <stdint.h>
+#include "network_info.h"
+#include "psram.h"
+
+inline uint64_t bssidKey(const uint8_t* mac) {
+  return ((uint64_t)mac[0] << 40) | ((uint64_t)mac[1] << 32) | ((uint64_t)mac[2] << 24) |
+         ((uint64_t)mac[3] << 16) | ((uint64_t)mac[4] << 8) | mac[5];
+}
+
+// BSSID-keyed table. Records live in a dense array (cheap to iterate for
+// serialization) indexed by an open-addressing hash of the 48-bit BSSID.
+// Both grow by doubling up to maxEntries; past that the least recently
+// observed BSS is evicted to make room.
+class BssTable {
+ public:
+  typedef void (*EvictHandler)(const NetworkInfo& evicted);
+
+  bool begin(uint32_t initialCapacity, uint32_t maxEntries);
+  void onEvict(EvictHandler handler) { evictHandler = handler; }
+
+  // Returns the record for `bssid`, creating it if needed, and marks it most
+  // recently used. Returns nullptr only if memory is exhausted.
+  NetworkInfo* upsert(const uint8_t* bssid, bool* inserted = nullptr);
+  NetworkInfo* find(const uint8_t* bssid);
+  void removeAt(uint32_t index);
+
+  uint32_t size() const { return count; }
+  NetworkInfo& at(uint32_t index) { return entries[index].info; }
+  const NetworkInfo& at(uint32_t index) const { return entries[index].info; }
+  uint64_t keyAt(uint32_t index) const { return entries[index].key; }
+
+  // Upserts are stamped with an increasing counter; stamp() is the latest
+  uint32_t stamp() const { return touchCounter; }
+  uint32_t stampAt(uint32_t index) const { return entries[index].touched; }
+  // Bumped by every removal, since removals move records between indexes
+  uint32_t layout() const { return layoutVersion; }
+
+  // Least recently upserted record, or -1 if the table is empty
+  int32_t oldest() const { return lruTail == NONE ? -1 : (int32_t)lruTail; }
+
+  uint32_t evictions() const { return evicted; }
+  size_t memoryUsed() const;
+
+ private:
+  struct Entry {
+    uint64_t key;
+    uint32_t touched;
+    uint32_t lruPrev;
+    uint32_t lruNext;
+    NetworkInfo info;
+  };
+
+  static const uint32_t NONE = 0xFFFFFFFF;
+
+  uint32_t slotFor(uint64_t key) const;
+  uint32_t findIndex(uint64_t key) const;
+  bool grow();
+  bool growEntries(uint32_t newCapacity);
+  bool growSlots(uint32_t forCapacity);
+  void insertSlot(uint64_t key, uint32_t index);
+  void eraseSlot(uint64_t key);
+  void lruUnlink(uint32_t index);
+  void lruPushFront(uint32_t index);
+
+  Entry* entries = nullptr;
+  uint32_t count = 0;
+  uint32_t capacity = 0;
+  uint32_t maxEntries = 0;
+
+  // Slot holds entry index + 1; 0 marks an empty slot
+  uint32_t* slots = nullptr;
+  uint32_t slotMask = 0;
+
+  uint32_t lruHead = NONE;
+  uint32_t lruTail = NONE;
+  uint32_t touchCounter = 0;
+  uint32_t layoutVersion = 0;
+  uint32_t evicted = 0;
+  EvictHandler evictHandler = nullptr;
+};
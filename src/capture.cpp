@@ -0,0 +1,76 @@
+#include "capture.h"
+#include <string.h>
+#include "hal.h"
+
+static FrameRing ring;
+static BeaconHandler beaconHandler = nullptr;
+static volatile bool enabled = false;
+
+static std::atomic<uint32_t> capturedFrames(0);
+static std::atomic<uint32_t> droppedFrames(0);
+static std::atomic<uint32_t> parsedFrames(0);
+static std::atomic<uint32_t> malformedFrames(0);
+
+// Runs in the radio's receive path: copy and return, never allocate or block
+static void HAL_IRAM onFrame(const uint8_t* data, uint16_t len, int8_t rssi, uint8_t channel, uint32_t timestamp) {
+  if(len == 0) return;
+  uint8_t subtype = data[0];
+  if(subtype != MGMT_SUBTYPE_BEACON && subtype != MGMT_SUBTYPE_PROBE_RESP) return;
+  
+  CapturedFrame* slot = ring.reserve();
+  if(!slot) {
+    droppedFrames.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  
+  if(len > CAPTURE_FRAME_MAX) len = CAPTURE_FRAME_MAX;
+  memcpy(slot->data, data, len);
+  slot->len = len;
+  slot->rssi = rssi;
+  slot->channel = channel;
+  slot->timestamp = timestamp;
+  ring.commit();
+  capturedFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void captureTask(void*) {
+  for(;;) {
+    while(CapturedFrame* frame = ring.peek()) {
+      // Parse in place; the slot is only released once the handler is done
+      MgmtFrameInfo info;
+      if(parseMgmtFrame(frame->data, frame->len, info)) {
+        parsedFrames.fetch_add(1, std::memory_order_relaxed);
+        if(beaconHandler) beaconHandler(info, *frame);
+      } else {
+        malformedFrames.fetch_add(1, std::memory_order_relaxed);
+      }
+      ring.pop();
+    }
+    halDelay(CAPTURE_POLL_MS);
+  }
+}
+
+void captureBegin(BeaconHandler handler) {
+  beaconHandler = handler;
+  halTaskCreate(captureTask, "capture", CAPTURE_STACK, CAPTURE_PRIORITY, CAPTURE_CORE);
+}
+
+void captureEnable(bool enable) {
+  if(enable == enabled) return;
+  
+  halPromiscuous(enable, onFrame);
+  enabled = enable;
+}
+
+bool captureEnabled() {
+  return enabled;
+}
+
+CaptureStats captureStats() {
+  CaptureStats stats;
+  stats.captured = capturedFrames.load();
+  stats.dropped = droppedFrames.load();
+  stats.parsed = parsedFrames.load();
+  stats.malformed = malformedFrames.load();
+  return stats;
+}
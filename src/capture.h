@@ -0,0 +1,62 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include "ie_parser.h"
+
+#define CAPTURE_SLOTS 64
+#define CAPTURE_FRAME_MAX 320
+#define CAPTURE_POLL_MS 10
+#define CAPTURE_CORE 0
+#define CAPTURE_STACK 4096
+#define CAPTURE_PRIORITY 1
+
+// One frame as copied out of the RX callback: the 802.11 header, fixed
+// fields and as many IEs as fit
+struct CapturedFrame {
+  uint16_t len;
+  int8_t rssi;
+  uint8_t channel;
+  uint32_t timestamp;
+  uint8_t data[CAPTURE_FRAME_MAX];
+};
+
+// Single-producer/single-consumer ring. The producer is the WiFi driver's
+// promiscuous callback, the consumer is the capture task; neither side locks.
+class FrameRing {
+ public:
+  CapturedFrame* reserve() {
+    uint32_t head = headIndex.load(std::memory_order_relaxed);
+    if(head - tailIndex.load(std::memory_order_acquire) >= CAPTURE_SLOTS) return nullptr;
+    return &slots[head % CAPTURE_SLOTS];
+  }
+  void commit() { headIndex.store(headIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  CapturedFrame* peek() {
+    uint32_t tail = tailIndex.load(std::memory_order_relaxed);
+    if(tail == headIndex.load(std::memory_order_acquire)) return nullptr;
+    return &slots[tail % CAPTURE_SLOTS];
+  }
+  void pop() { tailIndex.store(tailIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+ private:
+  CapturedFrame slots[CAPTURE_SLOTS];
+  std::atomic<uint32_t> headIndex{0};
+  std::atomic<uint32_t> tailIndex{0};
+};
+
+struct CaptureStats {
+  uint32_t captured;
+  uint32_t dropped;
+  uint32_t parsed;
+  uint32_t malformed;
+};
+
+// Called from the capture task while `frame` is still in the ring, so the
+// pointers in `info` stay valid for the duration of the call only
+typedef void (*BeaconHandler)(const MgmtFrameInfo& info, const CapturedFrame& frame);
+
+// Starts the consumer task; frames are only captured while enabled
+void captureBegin(BeaconHandler handler);
+void captureEnable(bool enable);
+bool captureEnabled();
+CaptureStats captureStats();
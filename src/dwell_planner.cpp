@@ -0,0 +1,69 @@
+#include "dwell_planner.h"
+
+// Density rises immediately with new APs and decays slowly, so a channel that
+// just lit up gets a long dwell on its next visit but one quiet sweep does not
+// starve a busy channel.
+#define DENSITY_DECAY 0.8f
+#define BUSY_DENSITY 0.5f
+#define DWELL_PER_AP_MS 12
+
+DwellPlanner::DwellPlanner(uint32_t sweepBudgetMs, uint16_t minDwellMs, uint16_t maxDwellMs, uint16_t busyDwellMs)
+  : sweepBudgetMs(sweepBudgetMs), minDwellMs(minDwellMs), maxDwellMs(maxDwellMs), busyDwellMs(busyDwellMs) {
+  // No history yet: treat every channel as busy so the first sweep is thorough
+  for(int i = 0; i < DWELL_CHANNELS; i++) density[i] = 1.0f;
+  rebalance();
+}
+
+void DwellPlanner::record(uint8_t channel, int apCount) {
+  if(channel < 1 || channel > DWELL_CHANNELS || apCount < 0) return;
+  
+  float& d = density[channel - 1];
+  float observed = (float)apCount;
+  d = observed > d ? observed : d * DENSITY_DECAY + observed * (1.0f - DENSITY_DECAY);
+  rebalance();
+}
+
+uint16_t DwellPlanner::dwellFor(uint8_t channel) const {
+  if(channel < 1 || channel > DWELL_CHANNELS) return maxDwellMs;
+  return dwell[channel - 1];
+}
+
+void DwellPlanner::setBudget(uint32_t budgetMs) {
+  sweepBudgetMs = budgetMs;
+  rebalance();
+}
+
+float DwellPlanner::densityOf(uint8_t channel) const {
+  if(channel < 1 || channel > DWELL_CHANNELS) return 0;
+  return density[channel - 1];
+}
+
+void DwellPlanner::rebalance() {
+  uint32_t floorTotal = (uint32_t)minDwellMs * DWELL_CHANNELS;
+  if(sweepBudgetMs <= floorTotal) {
+    for(int i = 0; i < DWELL_CHANNELS; i++) dwell[i] = sweepBudgetMs / DWELL_CHANNELS;
+    return;
+  }
+  
+  // Empty channels only get the minimum; channels with APs get the busy floor
+  // plus a little per expected AP, up to the per-channel cap
+  float want[DWELL_CHANNELS];
+  float total = 0;
+  for(int i = 0; i < DWELL_CHANNELS; i++) {
+    want[i] = minDwellMs;
+    if(density[i] >= BUSY_DENSITY) {
+      want[i] = busyDwellMs + DWELL_PER_AP_MS * density[i];
+      if(want[i] > maxDwellMs) want[i] = maxDwellMs;
+      if(want[i] < minDwellMs) want[i] = minDwellMs;
+    }
+    total += want[i];
+  }
+  
+  // Over budget: shrink everything above the minimum by the same factor
+  float scale = 1.0f;
+  if(total > sweepBudgetMs) scale = (sweepBudgetMs - floorTotal) / (total - floorTotal);
+  
+  for(int i = 0; i < DWELL_CHANNELS; i++) {
+    dwell[i] = (uint16_t)(minDwellMs + (want[i] - minDwellMs) * scale);
+  }
+}
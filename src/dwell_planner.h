@@ -0,0 +1,31 @@
+#pragma once
+#include <stdint.h>
+
+#define DWELL_CHANNELS 13
+
+// Picks a per-channel dwell time from how many APs each channel has shown
+// recently: busy channels get long dwells, empty ones the minimum, and the
+// whole sweep never exceeds the configured budget. No Arduino dependencies so
+// it can replay recorded traces on a host.
+class DwellPlanner {
+ public:
+  DwellPlanner(uint32_t sweepBudgetMs, uint16_t minDwellMs, uint16_t maxDwellMs, uint16_t busyDwellMs);
+
+  // Feed the AP count seen by the scan that just finished on `channel` (1-based)
+  void record(uint8_t channel, int apCount);
+  uint16_t dwellFor(uint8_t channel) const;
+
+  void setBudget(uint32_t sweepBudgetMs);
+  uint32_t budget() const { return sweepBudgetMs; }
+  float densityOf(uint8_t channel) const;
+
+ private:
+  void rebalance();
+
+  uint32_t sweepBudgetMs;
+  uint16_t minDwellMs;
+  uint16_t maxDwellMs;
+  uint16_t busyDwellMs;
+  float density[DWELL_CHANNELS];
+  uint16_t dwell[DWELL_CHANNELS];
+};
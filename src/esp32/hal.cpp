@@ -0,0 +1,93 @@
+#include "../hal.h"
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <esp_wifi.h>
+
+#define FCS_LEN 4
+
+static_assert(AUTH_OPEN == WIFI_AUTH_OPEN && AUTH_WPA2_PSK == WIFI_AUTH_WPA2_PSK &&
+              AUTH_WPA3_PSK == WIFI_AUTH_WPA3_PSK, "AUTH_* must match wifi_auth_mode_t");
+
+uint32_t halMillis() {
+  return millis();
+}
+
+uint64_t halMicros() {
+  return esp_timer_get_time();
+}
+
+uint32_t halRandom() {
+  return esp_random();
+}
+
+int halScanChannel(uint8_t channel, uint32_t dwellMs) {
+  int16_t result = WiFi.scanNetworks(false, true, false, dwellMs, channel);
+  return result < 0 ? -1 : result;
+}
+
+// Raw driver records avoid the String copies WiFi.SSID()/BSSIDstr() make
+bool halScanResult(int index, ScanResult& out) {
+  const wifi_ap_record_t* ap = (const wifi_ap_record_t*)WiFi.getScanInfoByIndex(index);
+  if(!ap) return false;
+  memcpy(out.bssid, ap->bssid, sizeof(out.bssid));
+  out.ssidLen = strnlen((const char*)ap->ssid, sizeof(out.ssid));
+  memcpy(out.ssid, ap->ssid, out.ssidLen);
+  out.rssi = ap->rssi;
+  out.channel = ap->primary;
+  out.authmode = ap->authmode;
+  return true;
+}
+
+void halScanRelease() {
+  WiFi.scanDelete();
+}
+
+static HalFrameHandler frameHandler = nullptr;
+
+// Runs in the WiFi driver task
+static void IRAM_ATTR onPromiscuousFrame(void* buf, wifi_promiscuous_pkt_type_t type) {
+  if(type != WIFI_PKT_MGMT) return;
+  const wifi_promiscuous_pkt_t* pkt = (const wifi_promiscuous_pkt_t*)buf;
+  uint16_t len = pkt->rx_ctrl.sig_len;
+  len = len > FCS_LEN ? len - FCS_LEN : 0;
+  frameHandler(pkt->payload, len, pkt->rx_ctrl.rssi, pkt->rx_ctrl.channel, pkt->rx_ctrl.timestamp);
+}
+
+void halPromiscuous(bool enable, HalFrameHandler handler) {
+  if(enable) {
+    frameHandler = handler;
+    wifi_promiscuous_filter_t filter = { WIFI_PROMIS_FILTER_MASK_MGMT };
+    esp_wifi_set_promiscuous_filter(&filter);
+    esp_wifi_set_promiscuous_rx_cb(onPromiscuousFrame);
+  }
+  esp_wifi_set_promiscuous(enable);
+}
+
+void halHeapInfo(HalHeapInfo& out) {
+  out.internalFree = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  out.internalLargest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+  out.psramFree = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+  out.psramLargest = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+}
+
+HalMutex halMutexCreate() {
+  return xSemaphoreCreateMutex();
+}
+
+void halMutexLock(HalMutex mutex) {
+  xSemaphoreTake((SemaphoreHandle_t)mutex, portMAX_DELAY);
+}
+
+void halMutexUnlock(HalMutex mutex) {
+  xSemaphoreGive((SemaphoreHandle_t)mutex);
+}
+
+void halTaskCreate(void (*task)(void*), const char* name, uint32_t stackSize, int priority, int core) {
+  xTaskCreatePinnedToCore(task, name, stackSize, nullptr, priority, nullptr, core < 0 ? tskNO_AFFINITY : core);
+}
+
+void halDelay(uint32_t ms) {
+  vTaskDelay(pdMS_TO_TICKS(ms));
+}
@@ -0,0 +1,37 @@
+#include "../psram.h"
+#include <stdlib.h>
+#include <esp_heap_caps.h>
+#include "../psram_stats.h"
+
+static PsramCounters counters;
+
+void* psramAlloc(size_t size) {
+  void* ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if(!ptr) ptr = malloc(size);
+  if(ptr) counters.allocated(heap_caps_get_allocated_size(ptr));
+  return ptr;
+}
+
+void* psramRealloc(void* ptr, size_t size) {
+  size_t before = ptr ? heap_caps_get_allocated_size(ptr) : 0;
+  void* grown = heap_caps_realloc(ptr, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if(!grown) grown = realloc(ptr, size);
+  if(!grown) return nullptr;
+  counters.freed(before);
+  counters.allocated(heap_caps_get_allocated_size(grown));
+  return grown;
+}
+
+void psramFree(void* ptr) {
+  if(!ptr) return;
+  counters.freed(heap_caps_get_allocated_size(ptr));
+  free(ptr);
+}
+
+PsramStats psramStats() {
+  return counters.stats();
+}
+
+void psramResetPeak() {
+  counters.resetPeak();
+}
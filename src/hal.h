@@ -0,0 +1,82 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Platform services the analyzer core is written against. src/esp32/
+// implements them with Arduino and ESP-IDF; src/native/ has Linux stand-ins
+// so the same core builds and runs on a host. Sockets are in hal_sockets.h
+// and memory in psram.h.
+
+#ifdef ARDUINO
+#include <esp_attr.h>
+#define HAL_IRAM IRAM_ATTR
+#else
+#define HAL_IRAM
+#endif
+
+// Auth modes as numbered by the ESP-IDF wifi_auth_mode_t
+#define AUTH_OPEN 0
+#define AUTH_WEP 1
+#define AUTH_WPA_PSK 2
+#define AUTH_WPA2_PSK 3
+#define AUTH_WPA_WPA2_PSK 4
+#define AUTH_WPA2_ENTERPRISE 5
+#define AUTH_WPA3_PSK 6
+
+// --- Clock ---
+
+// Milliseconds since boot; wraps like Arduino's millis()
+uint32_t halMillis();
+// Microseconds since boot, for timing short code paths
+uint64_t halMicros();
+uint32_t halRandom();
+
+// --- Scan source ---
+
+// One access point from a channel scan
+struct ScanResult {
+  uint8_t bssid[6];
+  uint8_t ssidLen;
+  uint8_t ssid[32];
+  int8_t rssi;
+  uint8_t channel;
+  uint8_t authmode;   // AUTH_*
+};
+
+// Blocking active scan of one channel for about `dwellMs`, hidden networks
+// included. Returns the number of results, or -1 on failure. Results stay
+// readable until halScanRelease().
+int halScanChannel(uint8_t channel, uint32_t dwellMs);
+bool halScanResult(int index, ScanResult& out);
+void halScanRelease();
+
+// --- Promiscuous capture ---
+
+// A received management frame without its FCS. Called from the radio's
+// receive path: copy what is needed and return, never block.
+typedef void (*HalFrameHandler)(const uint8_t* frame, uint16_t len, int8_t rssi, uint8_t channel, uint32_t timestamp);
+
+void halPromiscuous(bool enable, HalFrameHandler handler);
+
+// --- Memory ---
+
+struct HalHeapInfo {
+  size_t internalFree;
+  size_t internalLargest;   // largest block one allocation could get
+  size_t psramFree;
+  size_t psramLargest;
+};
+
+void halHeapInfo(HalHeapInfo& out);
+
+// --- Tasks ---
+
+typedef void* HalMutex;
+
+HalMutex halMutexCreate();
+void halMutexLock(HalMutex mutex);
+void halMutexUnlock(HalMutex mutex);
+
+// `core` pins the task where the platform has more than one; -1 for any
+void halTaskCreate(void (*task)(void*), const char* name, uint32_t stackSize, int priority, int core);
+void halDelay(uint32_t ms);
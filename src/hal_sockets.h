@@ -0,0 +1,18 @@
+#pragma once
+
+// The BSD socket subset the HTTP server uses: lwIP's on the ESP32, the
+// host's own elsewhere
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#else
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
@@ -0,0 +1,542 @@
+#include "http_server.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "hal.h"
+#include "hal_sockets.h"
+#include "websocket.h"
+
+static const char* statusText(int status) {
+  switch(status) {
+    case 101: return "Switching Protocols";
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 426: return "Upgrade Required";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+static int hexValue(char c) {
+  if(c >= '0' && c <= '9') return c - '0';
+  if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Offset just past the blank line ending the request head, or 0
+static size_t headEnd(const char* data, size_t len) {
+  for(size_t i = 3; i < len; i++) {
+    if(data[i] == '\n' && data[i - 1] == '\r' && data[i - 2] == '\n' && data[i - 3] == '\r') return i + 1;
+  }
+  return 0;
+}
+
+// --- HttpRequest ---
+
+const char* HttpRequest::header(const char* name) const {
+  for(int i = 0; i < headerCount; i++) {
+    if(strcasecmp(headerNames[i], name) == 0) return headerValues[i];
+  }
+  return nullptr;
+}
+
+const char* HttpRequest::arg(const char* name, char* out, size_t outSize) const {
+  size_t nameLen = strlen(name);
+  const char* p = query;
+  while(*p) {
+    const char* end = strchr(p, '&');
+    if(!end) end = p + strlen(p);
+  
+    if(strncmp(p, name, nameLen) == 0 && (p[nameLen] == '=' || p + nameLen == end)) {
+      const char* v = p[nameLen] == '=' ? p + nameLen + 1 : end;
+      size_t n = 0;
+      while(v < end && n + 1 < outSize) {
+        int hi, lo;
+        if(*v == '%' && end - v >= 3 && (hi = hexValue(v[1])) >= 0 && (lo = hexValue(v[2])) >= 0) {
+          out[n++] = (char)(hi << 4 | lo);
+          v += 3;
+        } else {
+          out[n++] = *v == '+' ? ' ' : *v;
+          v++;
+        }
+      }
+      out[n] = 0;
+      return out;
+    }
+    p = *end ? end + 1 : end;
+  }
+  return nullptr;
+}
+
+bool HttpRequest::hasArg(const char* name) const {
+  char scratch[1];
+  return arg(name, scratch, sizeof(scratch)) != nullptr;
+}
+
+// --- HttpConnection ---
+
+void HttpConnection::reset() {
+  while(segCount > 0) {
+    Segment& seg = segments[segHead];
+    if(seg.owner) sharedBodyRelease(seg.owner);
+    segHead = (segHead + 1) % HTTP_MAX_SEGMENTS;
+    segCount--;
+  }
+  fd = -1;
+  connKind = IDLE;
+  streamId = HTTP_STREAM_NONE;
+  keepAlive = closeAfterWrite = responded = headRequest = observing = false;
+  requestLen = headLen = extraLen = 0;
+  requests = 0;
+  segHead = 0;
+  segOffset = 0;
+}
+
+bool HttpConnection::queue(const char* data, size_t len, SharedBody* owner) {
+  if(segCount == HTTP_MAX_SEGMENTS) return false;
+  if(len == 0) return true;
+  Segment& seg = segments[(segHead + segCount) % HTTP_MAX_SEGMENTS];
+  seg.data = data;
+  seg.len = len;
+  seg.owner = owner ? sharedBodyRetain(owner) : nullptr;
+  segCount++;
+  return true;
+}
+
+size_t HttpConnection::pending() const {
+  size_t total = 0;
+  for(uint8_t i = 0; i < segCount; i++) total += segments[(segHead + i) % HTTP_MAX_SEGMENTS].len;
+  return total - segOffset;
+}
+
+void HttpConnection::addHeader(const char* name, const char* value) {
+  int n = snprintf(extraHeaders + extraLen, sizeof(extraHeaders) - extraLen, "%s: %s\r\n", name, value);
+  if(n > 0 && extraLen + n < sizeof(extraHeaders)) extraLen += n;
+}
+
+void HttpConnection::beginHead(int status, const char* type, size_t contentLength) {
+  responded = true;
+  headLen = snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\n", status, statusText(status));
+  if(type) headLen += snprintf(head + headLen, sizeof(head) - headLen, "Content-Type: %s\r\n", type);
+  if(contentLength != (size_t)-1) {
+    headLen += snprintf(head + headLen, sizeof(head) - headLen, "Content-Length: %u\r\n", (unsigned)contentLength);
+  }
+  if(connKind == HTTP) {
+    headLen += snprintf(head + headLen, sizeof(head) - headLen, "Connection: %s\r\n", keepAlive ? "keep-alive" : "close");
+  }
+  if(headLen + extraLen + 2 <= sizeof(head)) {
+    memcpy(head + headLen, extraHeaders, extraLen);
+    headLen += extraLen;
+  }
+  memcpy(head + headLen, "\r\n", 2);
+  headLen += 2;
+  extraLen = 0;
+  queue(head, headLen, nullptr);
+}
+
+void HttpConnection::send(int status, const char* type, const void* data, size_t len) {
+  beginHead(status, type, len);
+  if(!headRequest) queue((const char*)data, len, nullptr);
+}
+
+void HttpConnection::send(int status, const char* type, const char* text) {
+  send(status, type, text, strlen(text));
+}
+
+void HttpConnection::send(int status, const char* type, SharedBody* body) {
+  beginHead(status, type, body->len);
+  if(!headRequest) queue(body->data, body->len, body);
+}
+
+void HttpConnection::sendCopy(int status, const char* type, const void* data, size_t len) {
+  SharedBody* body = sharedBodyNew(0);
+  if(body) sharedBodyAppend(body, data, len);
+  if(!body || body->failed) send(503, "text/plain", "Out of memory");
+  else send(status, type, body);
+  if(body) sharedBodyRelease(body);
+}
+
+void HttpConnection::beginEventStream(uint8_t stream) {
+  connKind = EVENT_STREAM;
+  streamId = stream;
+  keepAlive = false;
+  addHeader("Cache-Control", "no-cache");
+  addHeader("Connection", "keep-alive");
+  beginHead(200, "text/event-stream", (size_t)-1);
+}
+
+bool HttpConnection::acceptWebSocket(const HttpRequest& req, uint8_t stream) {
+  const char* upgrade = req.header("Upgrade");
+  const char* key = req.header("Sec-WebSocket-Key");
+  if(!upgrade || strcasecmp(upgrade, "websocket") != 0 || !key) {
+    send(426, "text/plain", "WebSocket upgrade required");
+    return false;
+  }
+  
+  char accept[WS_ACCEPT_LEN + 1];
+  wsAcceptKey(key, accept);
+  connKind = WEBSOCKET;
+  streamId = stream;
+  keepAlive = false;
+  addHeader("Upgrade", "websocket");
+  addHeader("Connection", "Upgrade");
+  addHeader("Sec-WebSocket-Accept", accept);
+  beginHead(101, nullptr, (size_t)-1);
+  return true;
+}
+
+bool HttpConnection::write(SharedBody* body) {
+  return queue(body->data, body->len, body);
+}
+
+bool HttpConnection::write(const void* data, size_t len) {
+  return queue((const char*)data, len, nullptr);
+}
+
+bool HttpConnection::writeFrame(uint8_t opcode, const void* payload, size_t len) {
+  if(segCount == HTTP_MAX_SEGMENTS) return false;
+  SharedBody* frame = sharedBodyNew(0);
+  if(!frame) return false;
+  uint8_t header[WS_HEADER_MAX];
+  sharedBodyAppend(frame, header, wsFrameHeader(header, opcode, len));
+  sharedBodyAppend(frame, payload, len);
+  bool ok = !frame->failed && write(frame);
+  sharedBodyRelease(frame);
+  return ok;
+}
+
+// --- HttpServer ---
+
+bool HttpServer::begin(uint16_t port) {
+  for(int i = 0; i < HTTP_MAX_CONNECTIONS; i++) connections[i].reset();
+  
+  listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  if(listenFd < 0) return false;
+  int one = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if(bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd, 8) < 0) {
+    ::close(listenFd);
+    listenFd = -1;
+    return false;
+  }
+  fcntl(listenFd, F_SETFL, O_NONBLOCK);
+  return true;
+}
+
+void HttpServer::on(const char* path, Handler handler) {
+  if(routeCount == HTTP_MAX_ROUTES) return;
+  routes[routeCount].path = path;
+  routes[routeCount].handler = handler;
+  routeCount++;
+}
+
+int HttpServer::streamCount(uint8_t stream) const {
+  int n = 0;
+  for(int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+    if(connections[i].fd >= 0 && connections[i].streamId == stream) n++;
+  }
+  return n;
+}
+
+void HttpServer::poll(int timeoutMs) {
+  if(listenFd < 0) return;
+  
+  fd_set readable, writable;
+  FD_ZERO(&readable);
+  FD_ZERO(&writable);
+  int maxFd = -1;
+  bool slotFree = false;
+  
+  for(int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+    HttpConnection& conn = connections[i];
+    if(conn.fd < 0) {
+      slotFree = true;
+      continue;
+    }
+    // Requests are answered in order: the next one is only read once the
+    // current response is out. Streams are always read to notice closes.
+    if((conn.connKind != HttpConnection::HTTP && conn.connKind != HttpConnection::IDLE) || conn.segCount == 0) {
+      FD_SET(conn.fd, &readable);
+    }
+    if(conn.segCount > 0) FD_SET(conn.fd, &writable);
+    if(conn.fd > maxFd) maxFd = conn.fd;
+  }
+  // With every slot taken new clients wait in the listen backlog. Once one
+  // has been seen there the listener is left alone until a slot frees up.
+  if(slotFree || !slotPressure) {
+    FD_SET(listenFd, &readable);
+    if(listenFd > maxFd) maxFd = listenFd;
+  }
+  
+  struct timeval tv;
+  tv.tv_sec = timeoutMs / 1000;
+  tv.tv_usec = (timeoutMs % 1000) * 1000;
+  int ready = select(maxFd + 1, &readable, &writable, nullptr, &tv);
+  uint32_t now = halMillis();
+  
+  if(ready > 0 && FD_ISSET(listenFd, &readable)) {
+    if(slotFree) acceptClients(now);
+    else slotPressure = true;
+  }
+  
+  for(int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+    HttpConnection& conn = connections[i];
+    if(conn.fd < 0) continue;
+    int fd = conn.fd;
+    if(ready > 0 && FD_ISSET(fd, &readable)) readSocket(conn, now);
+    // Stream writes queued since the last poll go out without waiting for
+    // another round through select()
+    if(conn.fd >= 0 && conn.segCount > 0 && !flush(conn)) continue;
+    if(conn.fd < 0) continue;
+    if(conn.connKind == HttpConnection::IDLE && conn.requestLen > 0) processRequests(conn);
+    if(conn.fd < 0) continue;
+  
+    // Idle keep-alive connections and peers that stopped reading
+    // (sampled again: flush() may have moved lastActive past `now`)
+    uint32_t quiet = halMillis() - conn.lastActive;
+    bool waiting = conn.segCount == 0 && (conn.connKind == HttpConnection::IDLE || conn.connKind == HttpConnection::HTTP);
+    if(waiting && quiet > HTTP_IDLE_TIMEOUT_MS) drop(conn);
+    else if(conn.segCount > 0 && quiet > HTTP_STALL_TIMEOUT_MS) drop(conn);
+  }
+  
+  if(slotPressure) evictIdle(halMillis());
+}
+
+// Makes room for a waiting client: the keep-alive connection that has been
+// waiting longest for its next request goes, if it has waited long enough
+// that one is unlikely to be on its way. Busier connections are closed by
+// their next response instead (see dispatch()).
+void HttpServer::evictIdle(uint32_t now) {
+  HttpConnection* idlest = nullptr;
+  for(int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+    HttpConnection& conn = connections[i];
+    if(conn.fd < 0) return;  // a slot freed up on its own
+    if(conn.connKind != HttpConnection::IDLE || conn.segCount > 0 || conn.requestLen > 0) continue;
+    if(now - conn.lastActive < HTTP_EVICT_IDLE_MS) continue;
+    if(!idlest || now - conn.lastActive > now - idlest->lastActive) idlest = &conn;
+  }
+  if(idlest) drop(*idlest);
+}
+
+void HttpServer::acceptClients(uint32_t now) {
+  for(int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+    HttpConnection& conn = connections[i];
+    if(conn.fd >= 0) continue;
+  
+    int fd = accept(listenFd, nullptr, nullptr);
+    if(fd < 0) {
+      slotPressure = false;
+      return;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  
+    conn.reset();
+    conn.fd = fd;
+    conn.lastActive = now;
+  }
+}
+
+void HttpServer::readSocket(HttpConnection& conn, uint32_t now) {
+  size_t room = sizeof(conn.request) - 1 - conn.requestLen;
+  int n = recv(conn.fd, conn.request + conn.requestLen, room, MSG_DONTWAIT);
+  if(n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+    drop(conn);
+    return;
+  }
+  if(n < 0) return;
+  conn.requestLen += n;
+  conn.lastActive = now;
+  
+  switch(conn.connKind) {
+    case HttpConnection::WEBSOCKET: processWebSocket(conn); break;
+    // Nothing is expected from an event stream; discard it
+    case HttpConnection::EVENT_STREAM: conn.requestLen = 0; break;
+    default: processRequests(conn); break;
+  }
+}
+
+void HttpServer::processRequests(HttpConnection& conn) {
+  // Pipelined requests wait in the buffer until the response before them
+  // has been written
+  while(conn.fd >= 0 && conn.segCount == 0 && conn.connKind != HttpConnection::WEBSOCKET &&
+        conn.connKind != HttpConnection::EVENT_STREAM) {
+    size_t end = headEnd(conn.request, conn.requestLen);
+    if(end == 0) {
+      if(conn.requestLen == sizeof(conn.request) - 1) {
+        conn.connKind = HttpConnection::HTTP;
+        conn.keepAlive = false;
+        conn.send(431, "text/plain", "Request too large");
+        conn.close();
+        conn.requestLen = 0;
+      }
+      return;
+    }
+  
+    dispatch(conn, end);
+    memmove(conn.request, conn.request + end, conn.requestLen - end);
+    conn.requestLen -= end;
+    if(conn.closeAfterWrite) conn.requestLen = 0;
+    if(conn.segCount > 0) flush(conn);
+  }
+  if(conn.fd >= 0 && conn.connKind == HttpConnection::WEBSOCKET) processWebSocket(conn);
+}
+
+void HttpServer::dispatch(HttpConnection& conn, size_t end) {
+  char* p = conn.request;
+  p[end - 2] = 0;
+  
+  HttpRequest req;
+  req.headerCount = 0;
+  req.method = p;
+  char* target = strchr(p, ' ');
+  char* version = target ? strchr(target + 1, ' ') : nullptr;
+  char* lineEnd = strstr(p, "\r\n");
+  
+  conn.connKind = HttpConnection::HTTP;
+  conn.responded = false;
+  conn.extraLen = 0;
+  conn.route = -1;
+  conn.startedUs = (uint32_t)halMicros();
+  if(!target || !version || !lineEnd || version > lineEnd) {
+    conn.keepAlive = false;
+    conn.send(400, "text/plain", "Bad request");
+    conn.close();
+    return;
+  }
+  *target++ = 0;
+  *version++ = 0;
+  *lineEnd = 0;
+  
+  req.path = target;
+  char* q = strchr(target, '?');
+  if(q) *q++ = 0;
+  req.query = q ? q : "";
+  
+  // Header lines, trimmed; folded continuation lines are not supported
+  for(char* line = lineEnd + 2; *line && req.headerCount < HTTP_MAX_HEADERS;) {
+    char* next = strstr(line, "\r\n");
+    if(next) *next = 0;
+    char* colon = strchr(line, ':');
+    if(colon) {
+      *colon = 0;
+      char* value = colon + 1;
+      while(*value == ' ' || *value == '\t') value++;
+      req.headerNames[req.headerCount] = line;
+      req.headerValues[req.headerCount] = value;
+      req.headerCount++;
+    }
+    if(!next) break;
+    line = next + 2;
+  }
+  
+  const char* connection = req.header("Connection");
+  if(strcmp(version, "HTTP/1.1") == 0) conn.keepAlive = !connection || strcasecmp(connection, "close") != 0;
+  else conn.keepAlive = connection && strcasecmp(connection, "keep-alive") == 0;
+  // Request bodies are not read, so the stream cannot be trusted after one
+  const char* length = req.header("Content-Length");
+  if((length && atoi(length) > 0) || req.header("Transfer-Encoding")) conn.keepAlive = false;
+  if(++conn.requests >= HTTP_KEEPALIVE_MAX_REQUESTS || slotPressure) conn.keepAlive = false;
+  
+  conn.headRequest = strcmp(req.method, "HEAD") == 0;
+  if(!conn.headRequest && strcmp(req.method, "GET") != 0) {
+    conn.send(405, "text/plain", "Method not allowed");
+  } else {
+    Handler handler = notFound;
+    for(int i = 0; i < routeCount; i++) {
+      if(strcmp(routes[i].path, req.path) == 0) {
+        handler = routes[i].handler;
+        conn.route = i;
+        break;
+      }
+    }
+    if(handler) handler(conn, req);
+    else conn.send(404, "text/plain", "Not found");
+    if(!conn.responded) conn.send(500, "text/plain", "No response");
+  }
+  conn.headRequest = false;
+  if(!conn.keepAlive && conn.connKind == HttpConnection::HTTP) conn.close();
+  
+  conn.observing = responseObserver != nullptr;
+  conn.handlerUs = (uint32_t)halMicros() - conn.startedUs;
+  conn.responseBytes = conn.pending();
+}
+
+void HttpServer::processWebSocket(HttpConnection& conn) {
+  WsFrameInfo frame;
+  while(wsParseHeader((const uint8_t*)conn.request, conn.requestLen, frame)) {
+    size_t total = frame.headerLen + frame.payloadLen;
+    if(total > sizeof(conn.request) - 1) {
+      drop(conn);
+      return;
+    }
+    if(conn.requestLen < total) break;
+  
+    uint8_t* payload = (uint8_t*)conn.request + frame.headerLen;
+    wsUnmask(payload, frame.payloadLen, frame.mask);
+    if(frame.opcode == WS_OP_CLOSE) {
+      conn.writeFrame(WS_OP_CLOSE, payload, frame.payloadLen < 2 ? frame.payloadLen : 2);
+      conn.close();
+      conn.requestLen = 0;
+      return;
+    }
+    if(frame.opcode == WS_OP_PING) conn.writeFrame(WS_OP_PONG, payload, frame.payloadLen);
+    memmove(conn.request, conn.request + total, conn.requestLen - total);
+    conn.requestLen -= total;
+  }
+}
+
+// Writes as much as the socket takes. Returns false if the connection was
+// dropped.
+bool HttpServer::flush(HttpConnection& conn) {
+  while(conn.segCount > 0) {
+    HttpConnection::Segment& seg = conn.segments[conn.segHead];
+    int n = ::send(conn.fd, seg.data + conn.segOffset, seg.len - conn.segOffset, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if(n < 0) {
+      if(errno == EAGAIN || errno == EWOULDBLOCK) return true;
+      drop(conn);
+      return false;
+    }
+    conn.lastActive = halMillis();
+    conn.segOffset += n;
+    if(conn.segOffset < seg.len) return true;
+  
+    if(seg.owner) sharedBodyRelease(seg.owner);
+    conn.segHead = (conn.segHead + 1) % HTTP_MAX_SEGMENTS;
+    conn.segCount--;
+    conn.segOffset = 0;
+  }
+  
+  if(conn.observing) {
+    conn.observing = false;
+    responseObserver(conn.route, conn.handlerUs, (uint32_t)halMicros() - conn.startedUs, conn.responseBytes);
+  }
+  if(conn.closeAfterWrite) {
+    drop(conn);
+    return false;
+  }
+  // Response done: back to waiting for the next request on this connection
+  if(conn.connKind == HttpConnection::HTTP) conn.connKind = HttpConnection::IDLE;
+  return true;
+}
+
+void HttpServer::drop(HttpConnection& conn) {
+  ::close(conn.fd);
+  conn.reset();
+}
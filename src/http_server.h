@@ -0,0 +1,182 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "shared_body.h"
+
+#define HTTP_MAX_CONNECTIONS 10
+#define HTTP_MAX_ROUTES 12
+#define HTTP_MAX_HEADERS 24
+#define HTTP_REQUEST_MAX 1024
+#define HTTP_HEAD_MAX 384
+#define HTTP_EXTRA_HEADERS_MAX 192
+#define HTTP_MAX_SEGMENTS 16
+#define HTTP_IDLE_TIMEOUT_MS 15000
+#define HTTP_STALL_TIMEOUT_MS 10000
+#define HTTP_KEEPALIVE_MAX_REQUESTS 100
+#define HTTP_EVICT_IDLE_MS 200
+
+#define HTTP_STREAM_NONE 0
+
+// Single-task, event-driven HTTP/1.1 server on the BSD socket API (lwIP on
+// the ESP32, POSIX on a host). Every socket is non-blocking and poll() only
+// ever does as much reading and writing as the sockets accept, so one slow
+// client never holds up the others. Connections are kept alive between
+// requests, for at most HTTP_KEEPALIVE_MAX_REQUESTS of them; while a client
+// waits for a free slot, responses close their connection and the longest
+// idle keep-alive connection is evicted, so busy clients cannot hold every
+// slot.
+//
+// Handlers answer synchronously by queueing a response on the connection.
+// Bodies are never copied: they either point at static data (flash) or hold
+// a reference to a SharedBody until the last byte is written. Handlers can
+// also turn a connection into a long-lived stream (Server-Sent Events or a
+// WebSocket) tagged with a caller-chosen stream id and write to it later.
+
+class HttpRequest {
+ public:
+  const char* method;
+  const char* path;
+  const char* query;    // after '?', or "" if none
+
+  // Case-insensitive; nullptr if the header was not sent
+  const char* header(const char* name) const;
+  // Decoded query parameter copied into `out`; nullptr if absent
+  const char* arg(const char* name, char* out, size_t outSize) const;
+  bool hasArg(const char* name) const;
+
+ private:
+  friend class HttpServer;
+  const char* headerNames[HTTP_MAX_HEADERS];
+  const char* headerValues[HTTP_MAX_HEADERS];
+  int headerCount;
+};
+
+class HttpConnection {
+ public:
+  enum Kind : uint8_t { IDLE, HTTP, EVENT_STREAM, WEBSOCKET };
+
+  // Extra response header for the response about to be sent
+  void addHeader(const char* name, const char* value);
+
+  // Static body, e.g. a string literal or a table in flash
+  void send(int status, const char* type, const void* data, size_t len);
+  void send(int status, const char* type = nullptr, const char* text = "");
+  // Shared body; the connection takes its own reference
+  void send(int status, const char* type, SharedBody* body);
+  // Copies `data` first, for bodies built on the stack
+  void sendCopy(int status, const char* type, const void* data, size_t len);
+
+  // Switches to a text/event-stream response that stays open
+  void beginEventStream(uint8_t stream);
+  // Completes a WebSocket handshake; answers 426 and returns false if the
+  // request was not a valid upgrade
+  bool acceptWebSocket(const HttpRequest& req, uint8_t stream);
+
+  // Stream writes, queued behind whatever is still unsent. Return false if
+  // the queue is full; the data is then not sent.
+  bool write(SharedBody* body);
+  bool write(const void* data, size_t len);
+  // Queues one WebSocket frame around a copy of `payload`. Frames shared
+  // between connections should be framed once into a SharedBody instead.
+  bool writeFrame(uint8_t opcode, const void* payload, size_t len);
+
+  Kind kind() const { return connKind; }
+  uint8_t stream() const { return streamId; }
+  size_t pending() const;
+  // Closes once everything queued has been written
+  void close() { closeAfterWrite = true; }
+  bool closing() const { return closeAfterWrite; }
+
+ private:
+  friend class HttpServer;
+
+  struct Segment {
+    const char* data;
+    size_t len;
+    SharedBody* owner;
+  };
+
+  bool queue(const char* data, size_t len, SharedBody* owner);
+  void beginHead(int status, const char* type, size_t contentLength);
+  void reset();
+
+  int fd = -1;
+  Kind connKind = IDLE;
+  uint8_t streamId = HTTP_STREAM_NONE;
+  bool keepAlive = false;
+  bool closeAfterWrite = false;
+  bool responded = false;
+  bool headRequest = false;
+  uint16_t requests = 0;
+  uint32_t lastActive = 0;
+
+  // The response in flight, for HttpServer::onResponse()
+  bool observing = false;
+  int8_t route = -1;
+  uint32_t startedUs = 0;
+  uint32_t handlerUs = 0;
+  uint32_t responseBytes = 0;
+
+  char request[HTTP_REQUEST_MAX];
+  size_t requestLen = 0;
+
+  // Response status line and headers; extra headers accumulate here first
+  char head[HTTP_HEAD_MAX];
+  size_t headLen = 0;
+  char extraHeaders[HTTP_EXTRA_HEADERS_MAX];
+  size_t extraLen = 0;
+
+  Segment segments[HTTP_MAX_SEGMENTS];
+  uint8_t segHead = 0;
+  uint8_t segCount = 0;
+  size_t segOffset = 0;
+};
+
+class HttpServer {
+ public:
+  typedef void (*Handler)(HttpConnection& conn, const HttpRequest& req);
+  // Called once the head and any body of a response are fully written (for
+  // a stream, once its head is): the route in registration order or -1,
+  // microseconds spent in the handler and from dispatch to the last byte,
+  // and the bytes written
+  typedef void (*ResponseObserver)(int route, uint32_t handlerUs, uint32_t totalUs, uint32_t bytes);
+
+  bool begin(uint16_t port);
+  void on(const char* path, Handler handler);
+  void onNotFound(Handler handler) { notFound = handler; }
+  void onResponse(ResponseObserver observer) { responseObserver = observer; }
+  int registeredRoutes() const { return routeCount; }
+  const char* routePath(int route) const { return routes[route].path; }
+
+  // Services every socket that is ready, waiting at most `timeoutMs` for
+  // one to become ready
+  void poll(int timeoutMs);
+
+  // Stream connections for broadcasting
+  int connectionCount() const { return HTTP_MAX_CONNECTIONS; }
+  HttpConnection& connection(int i) { return connections[i]; }
+  int streamCount(uint8_t stream) const;
+
+ private:
+  void acceptClients(uint32_t now);
+  void evictIdle(uint32_t now);
+  void readSocket(HttpConnection& conn, uint32_t now);
+  void processRequests(HttpConnection& conn);
+  void dispatch(HttpConnection& conn, size_t end);
+  void processWebSocket(HttpConnection& conn);
+  bool flush(HttpConnection& conn);
+  void drop(HttpConnection& conn);
+
+  struct Route {
+    const char* path;
+    Handler handler;
+  };
+
+  int listenFd = -1;
+  bool slotPressure = false;  // a client is waiting for a free slot
+  Route routes[HTTP_MAX_ROUTES];
+  int routeCount = 0;
+  Handler notFound = nullptr;
+  ResponseObserver responseObserver = nullptr;
+  HttpConnection connections[HTTP_MAX_CONNECTIONS];
+};
@@ -0,0 +1,183 @@
+#include "ie_parser.h"
+#include <string.h>
+
+#define CAPABILITY_PRIVACY 0x0010
+
+static const uint8_t OUI_IEEE[3] = { 0x00, 0x0F, 0xAC };
+static const uint8_t OUI_MICROSOFT[3] = { 0x00, 0x50, 0xF2 };
+
+static inline uint16_t le16(const uint8_t* p) {
+  return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t le32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t suiteBit(const uint8_t* suite, const uint8_t* oui) {
+  if(memcmp(suite, oui, 3) != 0 || suite[3] >= 32) return 0;
+  return 1UL << suite[3];
+}
+
+// Shared layout of the RSN IE body and the WPA1 vendor IE body after its
+// OUI/type: version, group cipher, pairwise list, AKM list[, capabilities]
+static void parseSuites(const uint8_t* p, size_t len, const uint8_t* oui, SecurityInfo& sec) {
+  const uint8_t* end = p + len;
+  if(end - p < 2) return;
+  p += 2;  // version
+  
+  if(end - p < 4) return;
+  sec.groupCipher = (uint16_t)suiteBit(p, oui);
+  p += 4;
+  
+  if(end - p < 2) return;
+  uint16_t count = le16(p);
+  p += 2;
+  for(; count > 0 && end - p >= 4; count--, p += 4) sec.pairwise |= (uint16_t)suiteBit(p, oui);
+  
+  if(end - p < 2) return;
+  count = le16(p);
+  p += 2;
+  for(; count > 0 && end - p >= 4; count--, p += 4) sec.akm |= suiteBit(p, oui);
+  
+  if(end - p >= 2 && oui == OUI_IEEE) sec.rsnCapabilities = le16(p);
+}
+
+bool parseMgmtFrame(const uint8_t* frame, size_t len, MgmtFrameInfo& out) {
+  if(len < MGMT_HEADER_LEN + BEACON_FIXED_LEN) return false;
+  uint8_t subtype = frame[0];
+  if(subtype != MGMT_SUBTYPE_BEACON && subtype != MGMT_SUBTYPE_PROBE_RESP) return false;
+  
+  memset(&out, 0, sizeof(out));
+  out.subtype = subtype;
+  out.bssid = frame + 16;
+  
+  const uint8_t* fixed = frame + MGMT_HEADER_LEN;
+  out.tsf = le32(fixed) | ((uint64_t)le32(fixed + 4) << 32);
+  out.beaconInterval = le16(fixed + 8);
+  out.capability = le16(fixed + 10);
+  if(out.capability & CAPABILITY_PRIVACY) out.security.flags |= SEC_PRIVACY;
+  
+  IeIterator it(fixed + BEACON_FIXED_LEN, len - MGMT_HEADER_LEN - BEACON_FIXED_LEN);
+  IeView ie;
+  while(it.next(ie)) {
+    switch(ie.id) {
+      case IE_SSID:
+        if(ie.len <= 32 && !out.ssid) {
+          out.ssid = ie.data;
+          out.ssidLen = ie.len;
+        }
+        break;
+      case IE_DS_PARAMS:
+        if(ie.len >= 1) out.channel = ie.data[0];
+        break;
+      case IE_COUNTRY:
+        if(ie.len >= 3) out.country = ie.data;
+        break;
+      case IE_HT_CAPABILITIES:
+        out.phy |= PHY_HT;
+        if(ie.len >= 2) out.htCapabilities = le16(ie.data);
+        break;
+      case IE_HT_OPERATION:
+        if(ie.len >= 2) {
+          if(!out.channel) out.channel = ie.data[0];
+          out.htSecondaryOffset = ie.data[1] & 0x03;
+        }
+        break;
+      case IE_VHT_CAPABILITIES:
+        out.phy |= PHY_VHT;
+        if(ie.len >= 4) out.vhtCapabilities = le32(ie.data);
+        break;
+      case IE_VHT_OPERATION:
+        if(ie.len >= 1) out.vhtChannelWidth = ie.data[0];
+        break;
+      case IE_RSN:
+        out.security.flags |= SEC_RSN;
+        parseSuites(ie.data, ie.len, OUI_IEEE, out.security);
+        break;
+      case IE_VENDOR:
+        if(ie.len >= 4 && memcmp(ie.data, OUI_MICROSOFT, 3) == 0 && ie.data[3] == 1) {
+          out.security.flags |= SEC_WPA;
+          parseSuites(ie.data + 4, ie.len - 4, OUI_MICROSOFT, out.security);
+        }
+        if(ie.len >= 3 && out.vendorCount < MAX_VENDOR_IES) {
+          out.vendor[out.vendorCount] = ie.data;
+          out.vendorLen[out.vendorCount] = ie.len;
+          out.vendorCount++;
+        }
+        break;
+      case IE_EXTENSION:
+        if(ie.len >= 1 && ie.data[0] == IE_EXT_HE_CAPABILITIES) out.phy |= PHY_HE;
+        break;
+    }
+  }
+  out.truncated = it.truncated();
+  return true;
+}
+
+bool ssidHidden(const MgmtFrameInfo& info) {
+  for(uint8_t i = 0; i < info.ssidLen; i++) {
+    if(info.ssid[i] != 0) return false;
+  }
+  return true;
+}
+
+const char* securityLabel(const SecurityInfo& sec) {
+  if(sec.flags & (SEC_RSN | SEC_WPA)) {
+    bool enterprise = sec.akm & (AKM_8021X | AKM_FT_8021X | AKM_8021X_SHA256 | AKM_8021X_SUITE_B_192);
+    bool sae = sec.akm & (AKM_SAE | AKM_FT_SAE | AKM_SAE_EXT_KEY);
+    bool psk = sec.akm & (AKM_PSK | AKM_FT_PSK | AKM_PSK_SHA256);
+    
+    if(sec.akm & AKM_OWE) return "OWE";
+    if(!(sec.flags & SEC_RSN)) return enterprise ? "WPA-Enterprise" : "WPA";
+    if(enterprise) return (sec.akm & AKM_8021X_SUITE_B_192) ? "WPA3-Enterprise" : "WPA2-Enterprise";
+    if(sae) return psk ? "WPA2/WPA3" : "WPA3";
+    return (sec.flags & SEC_WPA) ? "WPA/WPA2" : "WPA2";
+  }
+  return (sec.flags & SEC_PRIVACY) ? "WEP" : "Open";
+}
+
+static size_t appendName(char* buf, size_t size, size_t pos, const char* name) {
+  if(pos > 0 && pos + 1 < size) buf[pos++] = '+';
+  while(*name && pos + 1 < size) buf[pos++] = *name++;
+  buf[pos] = 0;
+  return pos;
+}
+
+size_t formatCiphers(uint16_t ciphers, char* buf, size_t size) {
+  static const struct { uint16_t bit; const char* name; } names[] = {
+    { CIPHER_CCMP, "CCMP" }, { CIPHER_GCMP, "GCMP" }, { CIPHER_CCMP256, "CCMP-256" },
+    { CIPHER_GCMP256, "GCMP-256" }, { CIPHER_TKIP, "TKIP" }, { CIPHER_WEP104, "WEP104" },
+    { CIPHER_WEP40, "WEP40" },
+  };
+  if(size == 0) return 0;
+  size_t pos = 0;
+  buf[0] = 0;
+  for(const auto& n : names) {
+    if(ciphers & n.bit) pos = appendName(buf, size, pos, n.name);
+  }
+  return pos;
+}
+
+size_t formatAkms(uint32_t akms, char* buf, size_t size) {
+  static const struct { uint32_t bit; const char* name; } names[] = {
+    { AKM_PSK, "PSK" }, { AKM_PSK_SHA256, "PSK-SHA256" }, { AKM_FT_PSK, "FT-PSK" },
+    { AKM_SAE, "SAE" }, { AKM_FT_SAE, "FT-SAE" }, { AKM_SAE_EXT_KEY, "SAE-EXT" },
+    { AKM_8021X, "802.1X" }, { AKM_8021X_SHA256, "802.1X-SHA256" }, { AKM_FT_8021X, "FT-802.1X" },
+    { AKM_8021X_SUITE_B_192, "SuiteB-192" }, { AKM_OWE, "OWE" },
+  };
+  if(size == 0) return 0;
+  size_t pos = 0;
+  buf[0] = 0;
+  for(const auto& n : names) {
+    if(akms & n.bit) pos = appendName(buf, size, pos, n.name);
+  }
+  return pos;
+}
+
+const char* phyLabel(uint8_t phy) {
+  if(phy & PHY_HE) return "ax";
+  if(phy & PHY_VHT) return "ac";
+  if(phy & PHY_HT) return "n";
+  return "bg";
+}
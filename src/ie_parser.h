@@ -0,0 +1,142 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Zero-copy parser for 802.11 beacons and probe responses. Everything that
+// points at frame data (SSID, country, vendor IEs) points into the caller's
+// buffer, so the frame must outlive the MgmtFrameInfo. No Arduino
+// dependencies: builds for the target and for a native host.
+
+#define MGMT_SUBTYPE_PROBE_RESP 0x50
+#define MGMT_SUBTYPE_BEACON 0x80
+
+#define MGMT_HEADER_LEN 24
+#define BEACON_FIXED_LEN 12
+#define MAX_VENDOR_IES 6
+
+#define IE_SSID 0
+#define IE_DS_PARAMS 3
+#define IE_COUNTRY 7
+#define IE_HT_CAPABILITIES 45
+#define IE_RSN 48
+#define IE_HT_OPERATION 61
+#define IE_VHT_CAPABILITIES 191
+#define IE_VHT_OPERATION 192
+#define IE_VENDOR 221
+#define IE_EXTENSION 255
+#define IE_EXT_HE_CAPABILITIES 35
+
+// Cipher suite and AKM bits are (1 << suite type) for the 00-0F-AC OUI;
+// WPA1 suites (00-50-F2) map onto the same numbers
+#define CIPHER_WEP40 (1 << 1)
+#define CIPHER_TKIP (1 << 2)
+#define CIPHER_CCMP (1 << 4)
+#define CIPHER_WEP104 (1 << 5)
+#define CIPHER_GCMP (1 << 8)
+#define CIPHER_GCMP256 (1 << 9)
+#define CIPHER_CCMP256 (1 << 10)
+
+#define AKM_8021X (1UL << 1)
+#define AKM_PSK (1UL << 2)
+#define AKM_FT_8021X (1UL << 3)
+#define AKM_FT_PSK (1UL << 4)
+#define AKM_8021X_SHA256 (1UL << 5)
+#define AKM_PSK_SHA256 (1UL << 6)
+#define AKM_SAE (1UL << 8)
+#define AKM_FT_SAE (1UL << 9)
+#define AKM_8021X_SUITE_B_192 (1UL << 12)
+#define AKM_OWE (1UL << 18)
+#define AKM_SAE_EXT_KEY (1UL << 24)
+
+#define SEC_PRIVACY 0x01
+#define SEC_WPA 0x02
+#define SEC_RSN 0x04
+
+#define PHY_HT 0x01
+#define PHY_VHT 0x02
+#define PHY_HE 0x04
+
+struct IeView {
+  uint8_t id;
+  uint8_t len;
+  const uint8_t* data;
+};
+
+// Walks the tagged parameters in place. Stops at the first IE that would
+// run past the end and reports it through truncated().
+class IeIterator {
+ public:
+  IeIterator(const uint8_t* data, size_t len) : pos(data), end(data + len), cut(false) {}
+
+  bool next(IeView& ie) {
+    if(end - pos < 2) {
+      cut = pos != end;
+      return false;
+    }
+    if(end - pos - 2 < pos[1]) {
+      cut = true;
+      return false;
+    }
+    ie.id = pos[0];
+    ie.len = pos[1];
+    ie.data = pos + 2;
+    pos += 2 + ie.len;
+    return true;
+  }
+
+  bool truncated() const { return cut; }
+
+ private:
+  const uint8_t* pos;
+  const uint8_t* end;
+  bool cut;
+};
+
+struct SecurityInfo {
+  uint8_t flags;          // SEC_*
+  uint16_t groupCipher;   // CIPHER_* (single bit)
+  uint16_t pairwise;      // CIPHER_* union of RSN and WPA
+  uint32_t akm;           // AKM_* union of RSN and WPA
+  uint16_t rsnCapabilities;
+};
+
+struct MgmtFrameInfo {
+  uint8_t subtype;
+  const uint8_t* bssid;
+  uint64_t tsf;
+  uint16_t beaconInterval;
+  uint16_t capability;
+
+  const uint8_t* ssid;
+  uint8_t ssidLen;
+  uint8_t channel;        // DS parameter set, 0 if absent
+  const uint8_t* country; // 2-letter code + environment byte, or null
+
+  uint8_t phy;            // PHY_*
+  uint16_t htCapabilities;
+  uint8_t htSecondaryOffset;
+  uint32_t vhtCapabilities;
+  uint8_t vhtChannelWidth;
+
+  SecurityInfo security;
+
+  const uint8_t* vendor[MAX_VENDOR_IES]; // points at each vendor IE's OUI
+  uint8_t vendorLen[MAX_VENDOR_IES];
+  uint8_t vendorCount;
+
+  bool truncated;
+};
+
+// Returns false if the frame is not a beacon/probe response or is too short
+// to hold the fixed fields. A frame whose IE list is cut off still parses;
+// `truncated` is set and everything before the cut is filled in.
+bool parseMgmtFrame(const uint8_t* frame, size_t len, MgmtFrameInfo& out);
+
+// True if every SSID byte is zero or the SSID is empty (hidden network)
+bool ssidHidden(const MgmtFrameInfo& info);
+
+// Human-readable summaries, written into `buf` (always NUL-terminated)
+const char* securityLabel(const SecurityInfo& sec);
+size_t formatCiphers(uint16_t ciphers, char* buf, size_t size);
+size_t formatAkms(uint32_t akms, char* buf, size_t size);
+const char* phyLabel(uint8_t phy);
@@ -0,0 +1,243 @@
+#include "json_escape.h"
+#include <string.h>
+
+enum {
+  C_CLEAN = 0,
+  C_SHORT,      // ", \, \b, \f, \n, \r, \t
+  C_CONTROL,    // other bytes below 0x20
+  C_LEAD2,      // C2..DF
+  C_LEAD3,      // E0..EF
+  C_LEAD4,      // F0..F4
+  C_INVALID,    // stray continuation bytes, C0, C1, F5..FF
+};
+
+#define CL C_CLEAN
+#define SH C_SHORT
+#define CT C_CONTROL
+#define L2 C_LEAD2
+#define L3 C_LEAD3
+#define L4 C_LEAD4
+#define XX C_INVALID
+
+static const uint8_t byteClass[256] = {
+  CT, CT, CT, CT, CT, CT, CT, CT, SH, SH, SH, CT, SH, SH, CT, CT,  // 00
+  CT, CT, CT, CT, CT, CT, CT, CT, CT, CT, CT, CT, CT, CT, CT, CT,  // 10
+  CL, CL, SH, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL,  // 20
+  CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL,  // 30
+  CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL,  // 40
+  CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, SH, CL, CL, CL,  // 50
+  CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL,  // 60
+  CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL, CL,  // 70
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,  // 80
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,  // 90
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,  // A0
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,  // B0
+  XX, XX, L2, L2, L2, L2, L2, L2, L2, L2, L2, L2, L2, L2, L2, L2,  // C0
+  L2, L2, L2, L2, L2, L2, L2, L2, L2, L2, L2, L2, L2, L2, L2, L2,  // D0
+  L3, L3, L3, L3, L3, L3, L3, L3, L3, L3, L3, L3, L3, L3, L3, L3,  // E0
+  L4, L4, L4, L4, L4, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,  // F0
+};
+
+#undef CL
+#undef SH
+#undef CT
+#undef L2
+#undef L3
+#undef L4
+#undef XX
+
+static char shortEscape(uint8_t b) {
+  switch(b) {
+    case '\b': return 'b';
+    case '\f': return 'f';
+    case '\n': return 'n';
+    case '\r': return 'r';
+    case '\t': return 't';
+    default: return b;  // '"' and '\\'
+  }
+}
+
+typedef uintptr_t word_t;
+static const word_t ONES = (word_t)-1 / 0xFF;
+static const word_t HIGHS = ONES * 0x80;
+
+// Non-zero if any byte of `w` is below 0x20, equals '"' or '\', or has the
+// top bit set
+static inline word_t needsEscape(word_t w) {
+  word_t control = (w - ONES * 0x20) & ~w;
+  word_t quote = w ^ (ONES * '"');
+  word_t backslash = w ^ (ONES * '\\');
+  quote = (quote - ONES) & ~quote;
+  backslash = (backslash - ONES) & ~backslash;
+  return (control | quote | backslash | w) & HIGHS;
+}
+
+size_t jsonCleanRun(const uint8_t* data, size_t len) {
+  size_t i = 0;
+  word_t w;
+  while(len - i >= sizeof(word_t)) {
+    memcpy(&w, data + i, sizeof(w));
+    if(needsEscape(w)) break;
+    i += sizeof(word_t);
+  }
+  
+  // Short tail after clean words: one overlapping load of the last word
+  // usually settles it without going byte by byte
+  if(i < len && len - i < sizeof(word_t) && len >= sizeof(word_t)) {
+    memcpy(&w, data + len - sizeof(word_t), sizeof(w));
+    if(!needsEscape(w)) return len;
+  }
+  
+  while(i < len && byteClass[data[i]] == C_CLEAN) i++;
+  return i;
+}
+
+static inline bool continuation(uint8_t b) {
+  return (b & 0xC0) == 0x80;
+}
+
+// Length of the valid UTF-8 sequence at `data`, or 0 if it is not valid
+// (truncated, overlong, surrogate or above U+10FFFF)
+static size_t utf8Sequence(const uint8_t* data, size_t len, uint8_t cls) {
+  uint8_t b0 = data[0];
+  if(cls == C_LEAD2) {
+    return len >= 2 && continuation(data[1]) ? 2 : 0;
+  }
+  if(cls == C_LEAD3) {
+    if(len < 3 || !continuation(data[1]) || !continuation(data[2])) return 0;
+    if(b0 == 0xE0 && data[1] < 0xA0) return 0;
+    if(b0 == 0xED && data[1] >= 0xA0) return 0;
+    return 3;
+  }
+  if(len < 4 || !continuation(data[1]) || !continuation(data[2]) || !continuation(data[3])) return 0;
+  if(b0 == 0xF0 && data[1] < 0x90) return 0;
+  if(b0 == 0xF4 && data[1] >= 0x90) return 0;
+  return 4;
+}
+
+size_t jsonEscapeOne(const uint8_t* data, size_t len, char* out, size_t* outLen) {
+  static const char hex[] = "0123456789abcdef";
+  uint8_t b = data[0];
+  uint8_t cls = byteClass[b];
+  
+  switch(cls) {
+    case C_CLEAN:
+      out[0] = b;
+      *outLen = 1;
+      return 1;
+    case C_SHORT:
+      out[0] = '\\';
+      out[1] = shortEscape(b);
+      *outLen = 2;
+      return 1;
+    case C_CONTROL:
+      memcpy(out, "\\u00", 4);
+      out[4] = hex[b >> 4];
+      out[5] = hex[b & 0x0F];
+      *outLen = 6;
+      return 1;
+    case C_LEAD2:
+    case C_LEAD3:
+    case C_LEAD4: {
+      size_t n = utf8Sequence(data, len, cls);
+      if(n) {
+        memcpy(out, data, n);
+        *outLen = n;
+        return n;
+      }
+      break;
+    }
+  }
+  
+  // U+FFFD REPLACEMENT CHARACTER for each invalid byte
+  memcpy(out, "\xEF\xBF\xBD", 3);
+  *outLen = 3;
+  return 1;
+}
+
+// One byte or sequence of the per-byte path. Clean bytes and short escapes,
+// the bulk of densely escaped input, are handled here without a call.
+static inline void escapeStep(const uint8_t*& p, const uint8_t* end, char*& o) {
+  uint8_t b = *p;
+  uint8_t cls = byteClass[b];
+  if(cls == C_CLEAN) {
+    *o++ = b;
+    p++;
+    return;
+  }
+  if(cls == C_SHORT) {
+    o[0] = '\\';
+    o[1] = shortEscape(b);
+    o += 2;
+    p++;
+    return;
+  }
+  size_t outLen;
+  p += jsonEscapeOne(p, end - p, o, &outLen);
+  o += outLen;
+}
+
+// Length of the clean run at `p` when `flags` = needsEscape() of the word
+// there is non-zero. On a little-endian CPU that is the lowest flag:
+// borrows only carry towards later bytes, so the first flag is never a
+// false one.
+static inline size_t cleanPrefix(const uint8_t* p, word_t flags) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  (void)p;
+  return (sizeof(word_t) > sizeof(unsigned) ? __builtin_ctzll(flags) : __builtin_ctz(flags)) / 8;
+#else
+  (void)flags;
+  size_t i = 0;
+  while(byteClass[p[i]] == C_CLEAN) i++;
+  return i;
+#endif
+}
+
+// One pass that copies while it scans. Every word is stored as soon as it
+// is loaded, so clean input costs a load, a store and the SWAR test per
+// word; a word with something to escape keeps its clean prefix, the one
+// sequence is escaped over the rest, and scanning resumes right after it.
+// Escapes back to back mean dense input (non-ASCII names, mostly), where
+// testing words no longer pays: the rest goes byte by byte.
+size_t jsonEscape(const char* in, size_t len, char* out) {
+  const uint8_t* p = (const uint8_t*)in;
+  const uint8_t* end = p + len;
+  const uint8_t* escaped = nullptr;  // end of the last escaped sequence
+  char* o = out;
+  word_t w;
+  bool copied = false;  // the last word went out unchanged
+  
+  while((size_t)(end - p) >= sizeof(word_t)) {
+    memcpy(&w, p, sizeof(w));
+    memcpy(o, &w, sizeof(w));
+    word_t flags = needsEscape(w);
+    if(!flags) {
+      p += sizeof(word_t);
+      o += sizeof(word_t);
+      copied = true;
+      continue;
+    }
+  
+    size_t clean = cleanPrefix(p, flags);
+    if(clean == 0 && p == escaped) break;
+    p += clean;
+    o += clean;
+    escapeStep(p, end, o);
+    escaped = p;
+    copied = false;
+  }
+  
+  // Short tail after a clean word: the last word of input, overlapping
+  // bytes already copied as-is, can be stored over them unchanged
+  size_t tail = end - p;
+  if(copied && tail > 0 && tail < sizeof(word_t)) {
+    memcpy(&w, end - sizeof(word_t), sizeof(w));
+    if(!needsEscape(w)) {
+      memcpy(o + tail - sizeof(word_t), &w, sizeof(w));
+      return o + tail - out;
+    }
+  }
+  
+  while(p < end) escapeStep(p, end, o);
+  return o - out;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest escape produced for a single input sequence ("\u001f")
+#define JSON_ESCAPE_MAX 6
+
+// Length of the leading run of bytes that can be copied into a JSON string
+// as-is: printable ASCII other than '"' and '\'. Checks a machine word at a
+// time and only falls back to the class table for the word that ends the run.
+size_t jsonCleanRun(const uint8_t* data, size_t len);
+
+// Escapes the sequence starting at `data`, which must not be clean: a short
+// escape, a \u00XX control escape, a valid UTF-8 sequence copied through, or
+// U+FFFD for bytes that are not valid UTF-8. Writes at most JSON_ESCAPE_MAX
+// bytes to `out`, stores how many in `outLen`, returns input bytes consumed.
+size_t jsonEscapeOne(const uint8_t* data, size_t len, char* out, size_t* outLen);
+
+// Whole-buffer convenience wrapper; `out` needs len * JSON_ESCAPE_MAX bytes
+// in the worst case. Returns the escaped length.
+size_t jsonEscape(const char* in, size_t len, char* out);
@@ -0,0 +1,130 @@
+#include "json_writer.h"
+#include <string.h>
+#include "json_escape.h"
+
+JsonWriter::JsonWriter(char* buf, size_t size, FlushFn flush, void* ctx)
+  : buf(buf), size(size), used(0), total(0), flushFn(flush), ctx(ctx), depth(0), afterKey(false), hasItems(0) {}
+
+void JsonWriter::separate() {
+  if(afterKey) {
+    afterKey = false;
+    return;
+  }
+  uint32_t bit = 1UL << depth;
+  if(hasItems & bit) put(',');
+  hasItems |= bit;
+}
+
+void JsonWriter::beginObject() {
+  separate();
+  put('{');
+  if(depth + 1 < JSON_MAX_DEPTH) depth++;
+  hasItems &= ~(1UL << depth);
+}
+  
+void JsonWriter::endObject() {
+  put('}');
+  if(depth > 0) depth--;
+}
+
+void JsonWriter::beginArray() {
+  separate();
+  put('[');
+  if(depth + 1 < JSON_MAX_DEPTH) depth++;
+  hasItems &= ~(1UL << depth);
+}
+
+void JsonWriter::endArray() {
+  put(']');
+  if(depth > 0) depth--;
+}
+
+void JsonWriter::key(const char* name) {
+  separate();
+  put('"');
+  raw(name, strlen(name));
+  put('"');
+  put(':');
+  afterKey = true;
+}
+
+void JsonWriter::string(const char* value) {
+  string(value, strlen(value));
+}
+
+// Strings whose worst case fits the buffer (every SSID) are escaped in
+// place by jsonEscape(). Longer ones stream: clean runs are copied in bulk
+// and only the bytes that need escaping or UTF-8 validation go through the
+// per-sequence path.
+void JsonWriter::string(const char* value, size_t len) {
+  separate();
+  put('"');
+  if(len * JSON_ESCAPE_MAX <= size) {
+    if(size - used < len * JSON_ESCAPE_MAX) flush();
+    used += jsonEscape(value, len, buf + used);
+    put('"');
+    return;
+  }
+  
+  const uint8_t* p = (const uint8_t*)value;
+  while(len > 0) {
+    size_t clean = jsonCleanRun(p, len);
+    raw((const char*)p, clean);
+    p += clean;
+    len -= clean;
+    if(len == 0) break;
+  
+    char escaped[JSON_ESCAPE_MAX];
+    size_t escapedLen;
+    size_t consumed = jsonEscapeOne(p, len, escaped, &escapedLen);
+    raw(escaped, escapedLen);
+    p += consumed;
+    len -= consumed;
+  }
+  put('"');
+}
+
+void JsonWriter::number(uint32_t value) {
+  separate();
+  char digits[10];
+  int n = 0;
+  do {
+    digits[n++] = '0' + value % 10;
+    value /= 10;
+  } while(value);
+  while(n) put(digits[--n]);
+}
+
+void JsonWriter::number(int32_t value) {
+  if(value < 0) {
+    separate();
+    put('-');
+    afterKey = true;  // the digits belong to the same value
+    number((uint32_t)(-(int64_t)value));
+  } else {
+    number((uint32_t)value);
+  }
+}
+
+void JsonWriter::boolean(bool value) {
+  separate();
+  if(value) raw("true", 4); else raw("false", 5);
+}
+
+void JsonWriter::raw(const char* data, size_t len) {
+  while(len > 0) {
+    if(used == size) flush();
+    size_t n = size - used < len ? size - used : len;
+    memcpy(buf + used, data, n);
+    used += n;
+    data += n;
+    len -= n;
+  }
+}
+
+void JsonWriter::flush() {
+  if(used == 0) return;
+  flushFn(ctx, buf, used);
+  total += used;
+  used = 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#define JSON_MAX_DEPTH 16
+
+// Streams JSON into a caller-owned fixed buffer and hands it to `flush`
+// whenever it fills, so output size is independent of memory use. Tracks
+// commas itself; callers just emit keys and values in order.
+class JsonWriter {
+ public:
+  typedef void (*FlushFn)(void* ctx, const char* data, size_t len);
+
+  JsonWriter(char* buf, size_t size, FlushFn flush, void* ctx);
+
+  void beginObject();
+  void endObject();
+  void beginArray();
+  void endArray();
+  void key(const char* name);
+
+  // Escaped, with invalid UTF-8 replaced by U+FFFD
+  void string(const char* value);
+  void string(const char* value, size_t len);
+  void number(int32_t value);
+  void number(uint32_t value);
+  void boolean(bool value);
+
+  // Copies `len` bytes verbatim, e.g. pre-rendered JSON
+  void raw(const char* data, size_t len);
+  void flush();
+  size_t bytesWritten() const { return total + used; }
+
+ private:
+  void separate();
+  void put(char c) {
+    if(used == size) flush();
+    buf[used++] = c;
+  }
+
+  char* buf;
+  size_t size;
+  size_t used;
+  size_t total;
+  FlushFn flushFn;
+  void* ctx;
+
+  uint8_t depth;
+  bool afterKey;
+  uint32_t hasItems;  // bit per nesting level: emit a comma before the next item
+};
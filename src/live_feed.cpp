@@ -0,0 +1,61 @@
+#include "live_feed.h"
+#include "hal.h"
+
+static RssiSample ring[LIVE_RING_SLOTS];
+static std::atomic<uint32_t> headIndex(0);
+static std::atomic<uint32_t> tailIndex(0);
+static std::atomic<bool> active(false);
+static std::atomic<uint32_t> dropped(0);
+
+void livePush(uint16_t id, int8_t rssi, uint8_t channel) {
+  if(!active.load(std::memory_order_relaxed)) return;
+  
+  uint32_t head = headIndex.load(std::memory_order_relaxed);
+  if(head - tailIndex.load(std::memory_order_acquire) >= LIVE_RING_SLOTS) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  
+  RssiSample& slot = ring[head % LIVE_RING_SLOTS];
+  slot.id = id;
+  slot.rssi = rssi;
+  slot.channel = channel;
+  slot.time = halMillis();
+  headIndex.store(head + 1, std::memory_order_release);
+}
+
+static inline void putLe16(uint8_t* p, uint16_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+}
+
+size_t liveEncode(uint8_t* out, uint32_t now) {
+  uint32_t tail = tailIndex.load(std::memory_order_relaxed);
+  uint32_t head = headIndex.load(std::memory_order_acquire);
+  if(tail == head) return 0;
+  
+  putLe16(out, now);
+  putLe16(out + 2, now >> 16);
+  uint8_t* p = out + LIVE_HEADER_SIZE;
+  for(uint32_t n = 0; tail != head && n < LIVE_MAX_RECORDS; n++, tail++) {
+    const RssiSample& s = ring[tail % LIVE_RING_SLOTS];
+    uint32_t age = now - s.time;
+    putLe16(p, s.id);
+    p[2] = (uint8_t)s.rssi;
+    p[3] = s.channel;
+    putLe16(p + 4, age > 0xFFFF ? 0xFFFF : age);
+    p += LIVE_RECORD_SIZE;
+  }
+  tailIndex.store(tail, std::memory_order_release);
+  return p - out;
+}
+
+void liveSetActive(bool on) {
+  active.store(on, std::memory_order_relaxed);
+  // Whatever queued while nobody listened is stale; start from empty
+  if(!on) tailIndex.store(headIndex.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+uint32_t liveDropped() {
+  return dropped.load(std::memory_order_relaxed);
+}
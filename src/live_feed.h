@@ -0,0 +1,39 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define LIVE_RING_SLOTS 512
+#define LIVE_HEADER_SIZE 4
+#define LIVE_RECORD_SIZE 6
+#define LIVE_MAX_RECORDS 160
+#define LIVE_PAYLOAD_MAX (LIVE_HEADER_SIZE + LIVE_MAX_RECORDS * LIVE_RECORD_SIZE)
+
+// High-rate RSSI telemetry for the /live WebSocket. Every observation of a
+// BSS (scan result or captured beacon) becomes one sample; the HTTP loop
+// drains them into binary messages:
+//
+//   u32 device millis at encode time
+//   N x { u16 feed id, i8 rssi, u8 channel, u16 sample age in ms }
+//
+// All fields are little-endian. Feed ids are NetworkInfo::feedId, which
+// /scan and /events report as "id".
+struct RssiSample {
+  uint16_t id;
+  int8_t rssi;
+  uint8_t channel;
+  uint32_t time;
+};
+
+// Producers call this with tableMutex held, so the ring only ever sees one
+// writer at a time. It never blocks: with no subscribers it returns at once,
+// and a full ring drops the sample.
+void livePush(uint16_t id, int8_t rssi, uint8_t channel);
+
+// Drains up to LIVE_MAX_RECORDS samples into `out` (LIVE_PAYLOAD_MAX bytes).
+// Returns the message length, or 0 if there was nothing to send.
+size_t liveEncode(uint8_t* out, uint32_t now);
+
+// Samples are only queued while someone is listening
+void liveSetActive(bool active);
+uint32_t liveDropped();
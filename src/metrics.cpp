@@ -0,0 +1,51 @@
+#include "metrics.h"
+#include <stdio.h>
+
+// A truncated line would lose its newline and run into the next one, so
+// lines that do not fit are left out
+static void appendLine(SharedBody* out, const char* line, int len) {
+  if(len > 0 && len < METRICS_LINE_MAX) sharedBodyAppend(out, line, len);
+}
+
+void LogHistogram::write(SharedBody* out, const char* name, const char* labels, double scale) {
+  char line[METRICS_LINE_MAX];
+  const char* comma = labels[0] ? "," : "";
+  uint64_t cumulative = 0;
+  
+  // Counts are read one by one while writers carry on; each bucket is
+  // exact, the set is only as consistent as one scrape can be
+  for(int i = 0; i < METRICS_BUCKETS; i++) {
+    cumulative += buckets[i].load(std::memory_order_relaxed);
+    int len;
+    if(i < METRICS_BUCKETS - 1) {
+      len = snprintf(line, sizeof(line), "%s_bucket{%s%sle=\"%.9g\"} %llu\n", name, labels, comma,
+                     (double)(1UL << i) * scale, (unsigned long long)cumulative);
+    } else {
+      len = snprintf(line, sizeof(line), "%s_bucket{%s%sle=\"+Inf\"} %llu\n", name, labels, comma,
+                     (unsigned long long)cumulative);
+    }
+    appendLine(out, line, len);
+  }
+  
+  uint32_t sum = total.load(std::memory_order_relaxed);
+  widenedTotal += (uint32_t)(sum - exportedTotal);
+  exportedTotal = sum;
+  
+  const char* open = labels[0] ? "{" : "";
+  const char* close = labels[0] ? "}" : "";
+  appendLine(out, line, snprintf(line, sizeof(line), "%s_sum%s%s%s %.9g\n", name, open, labels, close,
+                                 widenedTotal * scale));
+  appendLine(out, line, snprintf(line, sizeof(line), "%s_count%s%s%s %llu\n", name, open, labels, close,
+                                 (unsigned long long)cumulative));
+}
+
+void metricsHeader(SharedBody* out, const char* name, const char* type, const char* help) {
+  char line[METRICS_LINE_MAX];
+  appendLine(out, line, snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type));
+}
+
+void metricsValue(SharedBody* out, const char* name, const char* labels, uint64_t value) {
+  char line[METRICS_LINE_MAX];
+  if(labels[0]) appendLine(out, line, snprintf(line, sizeof(line), "%s{%s} %llu\n", name, labels, (unsigned long long)value));
+  else appendLine(out, line, snprintf(line, sizeof(line), "%s %llu\n", name, (unsigned long long)value));
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "shared_body.h"
+
+#define METRICS_BUCKETS 20
+#define METRICS_LINE_MAX 192
+
+// Histogram over power-of-two buckets: bucket i counts values in
+// (2^(i-1), 2^i], bucket 0 everything up to 1 and the last one everything
+// past 2^(METRICS_BUCKETS - 2). observe() is a bit scan and two relaxed
+// 32-bit atomic adds, so it can stay on hot paths permanently. Values are in the
+// histogram's own unit; `scale` converts them to the exported base unit
+// (1e-6 for microseconds as seconds).
+class LogHistogram {
+ public:
+  void observe(uint32_t value) {
+    int i = value <= 1 ? 0 : 32 - __builtin_clz(value - 1);
+    if(i >= METRICS_BUCKETS) i = METRICS_BUCKETS - 1;
+    buckets[i].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  uint32_t count() const {
+    uint32_t n = 0;
+    for(const std::atomic<uint32_t>& b : buckets) n += b.load(std::memory_order_relaxed);
+    return n;
+  }
+
+  // Appends the _bucket, _sum and _count lines. `labels` is "" or a
+  // label list without braces, e.g. `route="/scan"`. Only one task may
+  // export a given histogram.
+  void write(SharedBody* out, const char* name, const char* labels, double scale);
+
+ private:
+  std::atomic<uint32_t> buckets[METRICS_BUCKETS] = {};
+  // 64-bit atomics take a lock on 32-bit Xtensa, so the sum is kept in 32
+  // bits and widened by the exporter, which adds up the (wrapping)
+  // difference since its last scrape
+  std::atomic<uint32_t> total{0};
+  uint32_t exportedTotal = 0;
+  uint64_t widenedTotal = 0;
+};
+
+// Prometheus text exposition format (version 0.0.4) into a SharedBody
+void metricsHeader(SharedBody* out, const char* name, const char* type, const char* help);
+void metricsValue(SharedBody* out, const char* name, const char* labels, uint64_t value);
@@ -0,0 +1,136 @@
+#include "native_hal.h"
+#include <malloc.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+typedef std::chrono::steady_clock Clock;
+static const Clock::time_point bootTime = Clock::now();
+
+uint32_t halMillis() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - bootTime).count();
+}
+
+uint64_t halMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - bootTime).count();
+}
+
+uint32_t halRandom() {
+  static std::mt19937 rng(std::random_device{}());
+  static std::mutex lock;
+  std::lock_guard<std::mutex> guard(lock);
+  return rng();
+}
+
+struct FixedAp {
+  const char* ssid;
+  uint8_t last;
+  uint8_t channel;
+  int8_t rssi;
+  uint8_t authmode;
+};
+
+static const FixedAp fixedAps[] = {
+  { "HomeNet", 0x01, 1, -42, AUTH_WPA2_PSK },
+  { "HomeNet-Guest", 0x02, 1, -48, AUTH_OPEN },
+  { "Office", 0x10, 6, -61, AUTH_WPA2_ENTERPRISE },
+  { "Cafe WiFi", 0x20, 6, -74, AUTH_OPEN },
+  { "", 0x21, 6, -80, AUTH_WPA2_PSK },
+  { "Neighbour", 0x30, 11, -67, AUTH_WPA_WPA2_PSK },
+  { "IoT-Hub", 0x31, 11, -55, AUTH_WPA3_PSK },
+};
+
+// A few fixed access points with a little RSSI jitter
+static int fixedScanSource(uint8_t channel, ScanResult* out, int max) {
+  int count = 0;
+  for(const FixedAp& ap : fixedAps) {
+    if(ap.channel != channel || count == max) continue;
+    ScanResult& r = out[count++];
+    const uint8_t bssid[6] = { 0x02, 0x00, 0x5e, 0x10, 0x00, ap.last };
+    memcpy(r.bssid, bssid, sizeof(bssid));
+    r.ssidLen = strlen(ap.ssid);
+    memcpy(r.ssid, ap.ssid, r.ssidLen);
+    r.rssi = ap.rssi + (int)(halRandom() % 5) - 2;
+    r.channel = channel;
+    r.authmode = ap.authmode;
+  }
+  return count;
+}
+
+static NativeScanSource scanSource = fixedScanSource;
+static std::atomic<bool> scanDelay(true);
+static ScanResult results[NATIVE_SCAN_MAX];
+static int resultCount = 0;
+
+void nativeSetScanSource(NativeScanSource source) {
+  scanSource = source ? source : fixedScanSource;
+}
+
+void nativeSetScanDelay(bool enabled) {
+  scanDelay = enabled;
+}
+
+int halScanChannel(uint8_t channel, uint32_t dwellMs) {
+  if(scanDelay) std::this_thread::sleep_for(std::chrono::milliseconds(dwellMs));
+  resultCount = scanSource(channel, results, NATIVE_SCAN_MAX);
+  return resultCount;
+}
+
+bool halScanResult(int index, ScanResult& out) {
+  if(index < 0 || index >= resultCount) return false;
+  out = results[index];
+  return true;
+}
+
+void halScanRelease() {
+  resultCount = 0;
+}
+
+static std::atomic<HalFrameHandler> frameHandler(nullptr);
+
+void halPromiscuous(bool enable, HalFrameHandler handler) {
+  frameHandler = enable ? handler : nullptr;
+}
+
+void nativeInjectFrame(const uint8_t* frame, uint16_t len, int8_t rssi, uint8_t channel) {
+  HalFrameHandler handler = frameHandler;
+  if(handler) handler(frame, len, rssi, channel, halMillis() * 1000);
+}
+
+// A host heap has no fixed size; report what malloc holds free where the
+// C library says so (mallinfo2 needs glibc 2.33) and no PSRAM
+void halHeapInfo(HalHeapInfo& out) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 info = mallinfo2();
+  out.internalFree = info.fordblks;
+#else
+  out.internalFree = 0;
+#endif
+  out.internalLargest = 0;
+  out.psramFree = 0;
+  out.psramLargest = 0;
+}
+
+HalMutex halMutexCreate() {
+  return new std::mutex();
+}
+
+void halMutexLock(HalMutex mutex) {
+  ((std::mutex*)mutex)->lock();
+}
+
+void halMutexUnlock(HalMutex mutex) {
+  ((std::mutex*)mutex)->unlock();
+}
+
+// Host threads are not pinned; the priority is ignored too
+void halTaskCreate(void (*task)(void*), const char*, uint32_t, int, int) {
+  std::thread(task, nullptr).detach();
+}
+
+void halDelay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../analyzer.h"
+#include "rf_sim.h"
+
+#define HTTP_PORT 8080
+
+static void usage(const char* program) {
+  fprintf(stderr,
+          "usage: %s [port] [options]\n"
+          "  --aps N        simulate N access points instead of the fixed handful\n"
+          "  --churn F      fraction of APs replaced per minute\n"
+          "  --mobile F     fraction of APs that are moving hotspots\n"
+          "  --walk M       observer speed in m/s\n"
+          "  --area M       side of the simulated area in metres\n"
+          "  --seed N       random seed\n"
+          "  --beacons      also inject beacon frames into capture\n",
+          program);
+}
+
+// Host build: the analyzer core with simulated scans, served on localhost.
+int main(int argc, char** argv) {
+  uint16_t port = HTTP_PORT;
+  RfSimConfig config;
+  bool simulate = false, beacons = false;
+  
+  for(int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if(strcmp(arg, "--beacons") == 0) {
+      beacons = simulate = true;
+      continue;
+    }
+    if(arg[0] != '-') {
+      port = atoi(arg);
+      continue;
+    }
+    if(!value) {
+      usage(argv[0]);
+      return 1;
+    }
+    i++;
+    simulate = true;
+    if(strcmp(arg, "--aps") == 0) config.apCount = atoi(value);
+    else if(strcmp(arg, "--churn") == 0) config.churnPerMinute = atof(value);
+    else if(strcmp(arg, "--mobile") == 0) config.mobileFraction = atof(value);
+    else if(strcmp(arg, "--walk") == 0) config.observerSpeed = atof(value);
+    else if(strcmp(arg, "--area") == 0) config.areaMeters = atof(value);
+    else if(strcmp(arg, "--seed") == 0) config.seed = strtoul(value, nullptr, 10);
+    else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  
+  if(simulate) {
+    RfSim* sim = new RfSim(config);
+    rfSimInstall(sim, beacons);
+    printf("Simulating %d access points\n", sim->apCount());
+  }
+  if(!analyzerBegin(port)) {
+    fprintf(stderr, "cannot listen on port %u\n", port);
+    return 1;
+  }
+  printf("WiFi Analyzer (native) on http://localhost:%u\n", port);
+  fflush(stdout);
+  
+  for(;;) analyzerLoop();
+}
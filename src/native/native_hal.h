@@ -0,0 +1,17 @@
+#pragma once
+#include "../hal.h"
+
+#define NATIVE_SCAN_MAX 1024
+
+// Host-only hooks into the native HAL, for simulators and benchmarks.
+
+// Fills `out` with what a scan of `channel` would find and returns the
+// count (at most `max`). Called from the scanner thread.
+typedef int (*NativeScanSource)(uint8_t channel, ScanResult* out, int max);
+
+// Replaces the built-in handful of fixed access points
+void nativeSetScanSource(NativeScanSource source);
+// Skips the dwell sleep so sweeps run as fast as the core can merge
+void nativeSetScanDelay(bool enabled);
+// Delivers a frame to the promiscuous handler, if capture is enabled
+void nativeInjectFrame(const uint8_t* frame, uint16_t len, int8_t rssi, uint8_t channel);
@@ -0,0 +1,36 @@
+#include "../psram.h"
+#include <malloc.h>
+#include <stdlib.h>
+#include "../psram_stats.h"
+
+static PsramCounters counters;
+
+// No PSRAM on a host; everything comes from the normal heap
+void* psramAlloc(size_t size) {
+  void* ptr = malloc(size);
+  if(ptr) counters.allocated(malloc_usable_size(ptr));
+  return ptr;
+}
+
+void* psramRealloc(void* ptr, size_t size) {
+  size_t before = ptr ? malloc_usable_size(ptr) : 0;
+  void* grown = realloc(ptr, size);
+  if(!grown) return nullptr;
+  counters.freed(before);
+  counters.allocated(malloc_usable_size(grown));
+  return grown;
+}
+
+void psramFree(void* ptr) {
+  if(!ptr) return;
+  counters.freed(malloc_usable_size(ptr));
+  free(ptr);
+}
+
+PsramStats psramStats() {
+  return counters.stats();
+}
+
+void psramResetPeak() {
+  counters.resetPeak();
+}
@@ -0,0 +1,250 @@
+#include "rf_sim.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include "native_hal.h"
+#include "../ie_parser.h"
+
+#define MOBILE_CHURN_FACTOR 10
+#define MAX_STEP_S 10.0f
+#define MESH_GROUP 8
+#define MESH_EVERY 10
+
+// Mix of names the JSON writer has to escape: quotes, backslashes, control
+// characters and multi-byte UTF-8
+static const char* const ssidPatterns[] = {
+  "HomeNet-%04X",
+  "FRITZ!Box 7590 %02X",
+  "Caf\xc3\xa9 \"Latte\" #%u",
+  "Guest\\Wing %u",
+  "Tab\there %u",
+  "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e-%u",
+  "A rather long network name %u with padding",
+};
+
+static const uint8_t rates[] = { 1, 8, 0x82, 0x84, 0x8b, 0x96, 0x0c, 0x12, 0x18, 0x24 };
+
+RfSim::RfSim(const RfSimConfig& config) : config(config), rng(config.seed), gauss(0.0f, 1.0f) {
+  for(float w : config.channelWeights) channelTotal += w;
+  observerX = observerTargetX = config.areaMeters / 2;
+  observerY = observerTargetY = config.areaMeters / 2;
+  
+  aps.resize(config.apCount);
+  for(Ap& ap : aps) spawn(ap);
+  appearedCount = 0;
+}
+
+float RfSim::uniform(float lo, float hi) {
+  return lo + (hi - lo) * (rng() / 4294967296.0f);
+}
+
+void RfSim::spawn(Ap& ap) {
+  ap.serial = nextSerial++;
+  ap.x = ap.targetX = uniform(0, config.areaMeters);
+  ap.y = ap.targetY = uniform(0, config.areaMeters);
+  ap.txPower = uniform(config.txPowerMinDbm, config.txPowerMaxDbm);
+  ap.shadowing = gauss(rng) * config.shadowingSigmaDb;
+  ap.mobile = uniform(0, 1) < config.mobileFraction;
+  ap.sequence = 0;
+  
+  float pick = uniform(0, channelTotal);
+  ap.channel = RF_SIM_CHANNELS;
+  for(int i = 0; i < RF_SIM_CHANNELS; i++) {
+    pick -= config.channelWeights[i];
+    if(pick < 0) {
+      ap.channel = i + 1;
+      break;
+    }
+  }
+  
+  float sec = uniform(0, 100);
+  if(ap.mobile) ap.authmode = AUTH_WPA2_PSK;
+  else if(sec < 60) ap.authmode = AUTH_WPA2_PSK;
+  else if(sec < 70) ap.authmode = AUTH_WPA_WPA2_PSK;
+  else if(sec < 80) ap.authmode = AUTH_WPA3_PSK;
+  else if(sec < 90) ap.authmode = AUTH_OPEN;
+  else if(sec < 97) ap.authmode = AUTH_WPA2_ENTERPRISE;
+  else ap.authmode = AUTH_WEP;
+  
+  makeSsid(ap);
+  appearedCount++;
+}
+
+void RfSim::makeSsid(Ap& ap) {
+  if(uniform(0, 1) < config.hiddenFraction) {
+    ap.ssidLen = 0;
+    return;
+  }
+  
+  char name[64];
+  if(ap.mobile) {
+    snprintf(name, sizeof(name), "Phone %u", ap.serial);
+  } else if((ap.serial / MESH_GROUP) % MESH_EVERY == 0) {
+    // Runs of consecutive APs share one name, like mesh nodes
+    snprintf(name, sizeof(name), "Mesh-%u", ap.serial / MESH_GROUP);
+  } else {
+    const char* pattern = ssidPatterns[rng() % (sizeof(ssidPatterns) / sizeof(ssidPatterns[0]))];
+    snprintf(name, sizeof(name), pattern, ap.serial & 0xffff);
+  }
+  // Truncated to the 802.11 maximum, possibly mid-character like real SSIDs
+  ap.ssidLen = strnlen(name, sizeof(ap.ssid));
+  memcpy(ap.ssid, name, ap.ssidLen);
+}
+
+// Random waypoint: head for the target, pick a new one on arrival
+void RfSim::walk(float& x, float& y, float& tx, float& ty, float distance) {
+  float dx = tx - x, dy = ty - y;
+  float left = sqrtf(dx * dx + dy * dy);
+  if(left > distance) {
+    x += dx / left * distance;
+    y += dy / left * distance;
+    return;
+  }
+  x = tx;
+  y = ty;
+  tx = uniform(0, config.areaMeters);
+  ty = uniform(0, config.areaMeters);
+}
+
+void RfSim::advance(uint32_t nowMs) {
+  std::lock_guard<std::mutex> guard(lock);
+  tsfUs = (uint64_t)nowMs * 1000;
+  if(!started) {
+    started = true;
+    lastAdvance = nowMs;
+    return;
+  }
+  float dt = (nowMs - lastAdvance) / 1000.0f;
+  if(dt <= 0) return;
+  if(dt > MAX_STEP_S) dt = MAX_STEP_S;
+  lastAdvance = nowMs;
+  
+  if(config.observerSpeed > 0) walk(observerX, observerY, observerTargetX, observerTargetY, config.observerSpeed * dt);
+  
+  float rate = config.churnPerMinute / 60.0f;
+  float replace = 1.0f - expf(-rate * dt);
+  float replaceMobile = 1.0f - expf(-rate * MOBILE_CHURN_FACTOR * dt);
+  for(Ap& ap : aps) {
+    if(ap.mobile) walk(ap.x, ap.y, ap.targetX, ap.targetY, config.mobileSpeed * dt);
+    if(rate > 0 && uniform(0, 1) < (ap.mobile ? replaceMobile : replace)) {
+      disappearedCount++;
+      spawn(ap);
+    }
+  }
+}
+
+bool RfSim::observe(const Ap& ap, int8_t& rssi) {
+  float dx = ap.x - observerX, dy = ap.y - observerY;
+  float d = sqrtf(dx * dx + dy * dy);
+  if(d < 1) d = 1;
+  float pathLoss = config.referenceLossDb + 10.0f * config.pathLossExponent * log10f(d);
+  float level = ap.txPower - pathLoss - ap.shadowing + gauss(rng) * config.fadingSigmaDb;
+  if(level < config.sensitivityDbm) return false;
+  rssi = level > -1 ? -1 : (int8_t)lrintf(level);
+  return true;
+}
+
+int RfSim::scan(uint8_t channel, ScanResult* out, int max) {
+  std::lock_guard<std::mutex> guard(lock);
+  int count = 0;
+  for(const Ap& ap : aps) {
+    if(count == max) break;
+    int8_t rssi;
+    if(ap.channel != channel || !observe(ap, rssi)) continue;
+  
+    ScanResult& r = out[count++];
+    const uint8_t bssid[6] = { 0x02, 0x53, 0x49, (uint8_t)(ap.serial >> 16), (uint8_t)(ap.serial >> 8), (uint8_t)ap.serial };
+    memcpy(r.bssid, bssid, sizeof(bssid));
+    r.ssidLen = ap.ssidLen;
+    memcpy(r.ssid, ap.ssid, ap.ssidLen);
+    r.rssi = rssi;
+    r.channel = channel;
+    r.authmode = ap.authmode;
+  }
+  return count;
+}
+
+static uint8_t* putIe(uint8_t* p, uint8_t id, const void* data, uint8_t len) {
+  p[0] = id;
+  p[1] = len;
+  memcpy(p + 2, data, len);
+  return p + 2 + len;
+}
+
+size_t RfSim::buildBeacon(Ap& ap, uint8_t* out) {
+  uint8_t* p = out;
+  const uint8_t bssid[6] = { 0x02, 0x53, 0x49, (uint8_t)(ap.serial >> 16), (uint8_t)(ap.serial >> 8), (uint8_t)ap.serial };
+  *p++ = MGMT_SUBTYPE_BEACON;
+  *p++ = 0;
+  *p++ = 0;
+  *p++ = 0;
+  memset(p, 0xff, 6);
+  memcpy(p + 6, bssid, 6);
+  memcpy(p + 12, bssid, 6);
+  p += 18;
+  uint16_t seq = (uint16_t)(ap.sequence++ << 4);
+  *p++ = seq & 0xff;
+  *p++ = seq >> 8;
+  
+  for(int i = 0; i < 8; i++) *p++ = (uint8_t)(tsfUs >> (8 * i));
+  *p++ = 0x64;  // 100 TU
+  *p++ = 0;
+  *p++ = ap.authmode == AUTH_OPEN ? 0x01 : 0x11;  // ESS, privacy
+  *p++ = 0x04;  // short slot
+  
+  p = putIe(p, IE_SSID, ap.ssid, ap.ssidLen);
+  p = putIe(p, 1, rates, sizeof(rates));
+  p = putIe(p, IE_DS_PARAMS, &ap.channel, 1);
+  
+  if(ap.authmode >= AUTH_WPA2_PSK && ap.authmode <= AUTH_WPA3_PSK) {
+    uint8_t akm = ap.authmode == AUTH_WPA3_PSK ? 8 : ap.authmode == AUTH_WPA2_ENTERPRISE ? 1 : 2;
+    const uint8_t rsn[] = { 1, 0, 0x00, 0x0f, 0xac, 4, 1, 0, 0x00, 0x0f, 0xac, 4, 1, 0, 0x00, 0x0f, 0xac, akm, 0, 0 };
+    p = putIe(p, IE_RSN, rsn, sizeof(rsn));
+  }
+  if(ap.authmode == AUTH_WPA_PSK || ap.authmode == AUTH_WPA_WPA2_PSK) {
+    const uint8_t wpa[] = { 0x00, 0x50, 0xf2, 1, 1, 0, 0x00, 0x50, 0xf2, 2, 1, 0, 0x00, 0x50, 0xf2, 2, 1, 0, 0x00, 0x50, 0xf2, 2 };
+    p = putIe(p, IE_VENDOR, wpa, sizeof(wpa));
+  }
+  
+  uint8_t ht[26] = { 0x2c, 0x01 };
+  p = putIe(p, IE_HT_CAPABILITIES, ht, sizeof(ht));
+  return p - out;
+}
+
+int RfSim::beacons(uint8_t channel, BeaconSink emit) {
+  std::lock_guard<std::mutex> guard(lock);
+  uint8_t frame[RF_SIM_BEACON_MAX];
+  int count = 0;
+  for(Ap& ap : aps) {
+    int8_t rssi;
+    if(ap.channel != channel || !observe(ap, rssi)) continue;
+    emit(frame, buildBeacon(ap, frame), rssi, channel);
+    count++;
+  }
+  return count;
+}
+
+static RfSim* installed = nullptr;
+static std::atomic<uint8_t> tunedChannel(1);
+
+static int simScanSource(uint8_t channel, ScanResult* out, int max) {
+  tunedChannel = channel;
+  installed->advance(halMillis());
+  return installed->scan(channel, out, max);
+}
+
+// The radio hears whatever channel the scanner left it on
+static void beaconTask(void*) {
+  for(;;) {
+    installed->advance(halMillis());
+    installed->beacons(tunedChannel, nativeInjectFrame);
+    halDelay(RF_SIM_BEACON_INTERVAL_MS);
+  }
+}
+
+void rfSimInstall(RfSim* sim, bool beacons) {
+  installed = sim;
+  nativeSetScanSource(simScanSource);
+  if(beacons) halTaskCreate(beaconTask, "rf-beacons", 0, 0, -1);
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+#include <random>
+#include <vector>
+#include "../hal.h"
+
+#define RF_SIM_CHANNELS 13
+#define RF_SIM_BEACON_MAX 192
+#define RF_SIM_BEACON_INTERVAL_MS 102
+
+// Synthetic RF environment for soak and scale testing on a host. Access
+// points sit in a square area around a moving observer; what a scan of a
+// channel finds follows the log-distance path loss model
+//   rssi = txPower - (refLoss + 10 n log10(d)) - shadowing - fading
+// with a fixed per-AP log-normal shadowing term and a fresh fading draw per
+// observation. APs are replaced at the churn rate (new BSSIDs, so the table
+// sees real inserts and expiries) and a fraction of them are mobile
+// hotspots that wander and come and go ten times as often.
+struct RfSimConfig {
+  uint32_t seed = 1;
+  int apCount = 200;                    // mean population
+  float channelWeights[RF_SIM_CHANNELS] = { 25, 2, 2, 2, 2, 30, 2, 2, 2, 2, 25, 2, 2 };
+  float areaMeters = 300;               // side of the square
+  float pathLossExponent = 3.0f;
+  float referenceLossDb = 40.0f;        // at 1 m, 2.4 GHz
+  float shadowingSigmaDb = 6.0f;
+  float fadingSigmaDb = 2.0f;
+  float sensitivityDbm = -92.0f;
+  float txPowerMinDbm = 14.0f;
+  float txPowerMaxDbm = 23.0f;
+  float churnPerMinute = 0.0f;          // fraction of the population replaced
+  float mobileFraction = 0.02f;
+  float mobileSpeed = 1.4f;             // m/s
+  float observerSpeed = 0.0f;           // m/s, random waypoint
+  float hiddenFraction = 0.05f;
+};
+
+class RfSim {
+ public:
+  explicit RfSim(const RfSimConfig& config);
+
+  // Moves APs and the observer and applies churn up to `nowMs`
+  void advance(uint32_t nowMs);
+
+  // What an active scan of `channel` finds right now, at most `max`
+  int scan(uint8_t channel, ScanResult* out, int max);
+
+  // One beacon interval's worth of beacons audible on `channel`, each
+  // passed to `emit` as a raw frame without FCS
+  typedef void (*BeaconSink)(const uint8_t* frame, uint16_t len, int8_t rssi, uint8_t channel);
+  int beacons(uint8_t channel, BeaconSink emit);
+
+  int apCount() const { return aps.size(); }
+  uint32_t appeared() const { return appearedCount; }
+  uint32_t disappeared() const { return disappearedCount; }
+
+ private:
+  struct Ap {
+    uint32_t serial;
+    float x, y;
+    float targetX, targetY;
+    float txPower;
+    float shadowing;
+    uint8_t channel;
+    uint8_t authmode;
+    bool mobile;
+    uint8_t ssidLen;
+    uint8_t ssid[32];
+    uint16_t sequence;
+  };
+
+  void spawn(Ap& ap);
+  void makeSsid(Ap& ap);
+  void walk(float& x, float& y, float& tx, float& ty, float distance);
+  bool observe(const Ap& ap, int8_t& rssi);
+  size_t buildBeacon(Ap& ap, uint8_t* out);
+  float uniform(float lo, float hi);
+
+  RfSimConfig config;
+  std::mutex lock;
+  std::mt19937 rng;
+  std::normal_distribution<float> gauss;
+  std::vector<Ap> aps;
+  float channelTotal = 0;
+  float observerX, observerY, observerTargetX, observerTargetY;
+  uint32_t lastAdvance = 0;
+  bool started = false;
+  uint32_t nextSerial = 1;
+  uint32_t appearedCount = 0;
+  uint32_t disappearedCount = 0;
+  uint64_t tsfUs = 0;
+};
+
+// Installs `sim` as the native HAL's scan source and, if `beacons` is set,
+// starts a thread injecting its beacons on the channel last scanned
+void rfSimInstall(RfSim* sim, bool beacons);
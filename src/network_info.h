@@ -0,0 +1,48 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include "ie_parser.h"
+
+#define NET_HIDDEN 0x01
+#define NET_DETAILED 0x02  // security/phy/country come from a captured beacon
+
+// Fixed-size, allocation-free BSS record. Text forms (BSSID string, hidden
+// placeholder, security labels) are produced only when serializing.
+struct NetworkInfo {
+  uint8_t bssid[6];
+  uint8_t ssidLen;
+  char ssid[32];          // not NUL-terminated
+  int8_t rssi;
+  int8_t reportedRssi;    // RSSI as of changedGen
+  uint8_t channel;
+  uint8_t encryption;     // wifi_auth_mode_t from the driver
+  uint8_t flags;          // NET_*
+  uint8_t phy;
+  char country[2];
+  uint32_t firstSeen;
+  uint32_t lastSeen;
+  uint32_t seenCount;     // scan sightings plus captured beacons
+  uint32_t beacons;
+  uint32_t changedGen;    // generation that first published the current state
+  uint16_t feedId;        // short id used by the binary live feed
+  SecurityInfo security;
+};
+
+static_assert(std::is_trivially_copyable<NetworkInfo>::value, "NetworkInfo must stay POD");
+
+inline void setSsid(NetworkInfo& net, const uint8_t* ssid, uint8_t len) {
+  if(len > sizeof(net.ssid)) len = sizeof(net.ssid);
+  memcpy(net.ssid, ssid, len);
+  net.ssidLen = len;
+}
+
+// Writes "AA:BB:CC:DD:EE:FF" plus NUL into `out` (at least 18 bytes)
+inline void formatBssid(const uint8_t* mac, char* out) {
+  static const char hex[] = "0123456789ABCDEF";
+  for(int i = 0; i < 6; i++) {
+    out[i * 3] = hex[mac[i] >> 4];
+    out[i * 3 + 1] = hex[mac[i] & 0x0F];
+    out[i * 3 + 2] = i < 5 ? ':' : 0;
+  }
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Allocates from PSRAM when present, falling back to internal RAM
+void* psramAlloc(size_t size);
+void* psramRealloc(void* ptr, size_t size);
+void psramFree(void* ptr);
+
+// Running totals over every block handed out above, for benchmarks and
+// /metrics. Sizes are the allocator's usable sizes, so they include its
+// rounding.
+struct PsramStats {
+  uint32_t allocations;
+  uint64_t allocatedBytes;  // cumulative, never decreases
+  size_t liveBytes;
+  size_t peakBytes;         // highest liveBytes since the last reset
+};
+
+PsramStats psramStats();
+void psramResetPeak();
@@ -0,0 +1,33 @@
+#pragma once
+#include <atomic>
+#include "psram.h"
+
+// Shared bookkeeping for the platform psram.cpp files; each one reports
+// block sizes from its own allocator
+class PsramCounters {
+ public:
+  void allocated(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    size_t now = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = peakBytes.load(std::memory_order_relaxed);
+    while(now > peak && !peakBytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+  }
+  void freed(size_t size) { liveBytes.fetch_sub(size, std::memory_order_relaxed); }
+
+  PsramStats stats() const {
+    PsramStats s;
+    s.allocations = allocations.load(std::memory_order_relaxed);
+    s.allocatedBytes = allocatedBytes.load(std::memory_order_relaxed);
+    s.liveBytes = liveBytes.load(std::memory_order_relaxed);
+    s.peakBytes = peakBytes.load(std::memory_order_relaxed);
+    return s;
+  }
+  void resetPeak() { peakBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint32_t> allocations{0};
+  std::atomic<uint64_t> allocatedBytes{0};
+  std::atomic<size_t> liveBytes{0};
+  std::atomic<size_t> peakBytes{0};
+};
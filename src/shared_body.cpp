@@ -0,0 +1,40 @@
+#include "shared_body.h"
+#include <string.h>
+#include "psram.h"
+
+SharedBody* sharedBodyNew(uint32_t tag) {
+  SharedBody* body = (SharedBody*)psramAlloc(sizeof(SharedBody));
+  if(!body) return nullptr;
+  memset(body, 0, sizeof(*body));
+  body->refs = 1;
+  body->tag = tag;
+  return body;
+}
+
+void sharedBodyRelease(SharedBody* body) {
+  if(--body->refs > 0) return;
+  psramFree(body->data);
+  psramFree(body);
+}
+
+void sharedBodyAppend(SharedBody* body, const void* data, size_t len) {
+  if(body->failed) return;
+  
+  if(body->len + len > body->capacity) {
+    size_t capacity = body->capacity ? body->capacity * 2 : 1024;
+    while(capacity < body->len + len) capacity *= 2;
+    char* grown = (char*)psramRealloc(body->data, capacity);
+    if(!grown) {
+      body->failed = true;
+      return;
+    }
+    body->data = grown;
+    body->capacity = capacity;
+  }
+  memcpy(body->data + body->len, data, len);
+  body->len += len;
+}
+
+void sharedBodySink(void* ctx, const char* data, size_t len) {
+  sharedBodyAppend((SharedBody*)ctx, data, len);
+}
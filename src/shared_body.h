@@ -0,0 +1,28 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Reference-counted byte buffer in PSRAM, for response bodies that are
+// rendered once and written to many connections. Reference counts are not
+// atomic: bodies belong to the HTTP task.
+struct SharedBody {
+  int refs;
+  bool failed;        // an append ran out of memory; contents are incomplete
+  uint32_t tag;       // caller-defined version, e.g. the scan generation
+  size_t len;
+  size_t capacity;
+  char* data;
+};
+
+// New empty body holding one reference, or nullptr if out of memory
+SharedBody* sharedBodyNew(uint32_t tag);
+inline SharedBody* sharedBodyRetain(SharedBody* body) {
+  body->refs++;
+  return body;
+}
+void sharedBodyRelease(SharedBody* body);
+
+void sharedBodyAppend(SharedBody* body, const void* data, size_t len);
+
+// JsonWriter flush callback; `ctx` is the SharedBody
+void sharedBodySink(void* ctx, const char* data, size_t len);
@@ -0,0 +1,123 @@
+#include "websocket.h"
+#include <string.h>
+
+static const char WS_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+static inline uint32_t rol(uint32_t v, int bits) {
+  return (v << bits) | (v >> (32 - bits));
+}
+
+static void sha1Block(uint32_t* h, const uint8_t* block) {
+  uint32_t w[80];
+  for(int i = 0; i < 16; i++) {
+    w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+           ((uint32_t)block[i * 4 + 2] << 8) | block[i * 4 + 3];
+  }
+  for(int i = 16; i < 80; i++) w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+  
+  uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+  for(int i = 0; i < 80; i++) {
+    uint32_t f, k;
+    if(i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+    else if(i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+    else if(i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+    else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+    uint32_t t = rol(a, 5) + f + e + k + w[i];
+    e = d; d = c; c = rol(b, 30); b = a; a = t;
+  }
+  h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+}
+
+void sha1(const uint8_t* data, size_t len, uint8_t* digest) {
+  uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+  size_t done = 0;
+  for(; len - done >= 64; done += 64) sha1Block(h, data + done);
+  
+  // Final block(s): remaining bytes, 0x80, zero padding, 64-bit bit length
+  uint8_t tail[128];
+  size_t rest = len - done;
+  memcpy(tail, data + done, rest);
+  tail[rest] = 0x80;
+  size_t tailLen = rest + 9 <= 64 ? 64 : 128;
+  memset(tail + rest + 1, 0, tailLen - rest - 1);
+  uint64_t bits = (uint64_t)len * 8;
+  for(int i = 0; i < 8; i++) tail[tailLen - 1 - i] = bits >> (i * 8);
+  for(size_t i = 0; i < tailLen; i += 64) sha1Block(h, tail + i);
+  
+  for(int i = 0; i < 5; i++) {
+    digest[i * 4] = h[i] >> 24;
+    digest[i * 4 + 1] = h[i] >> 16;
+    digest[i * 4 + 2] = h[i] >> 8;
+    digest[i * 4 + 3] = h[i];
+  }
+}
+
+void wsAcceptKey(const char* key, char* out) {
+  // Keys are 24 base64 characters; anything longer is cut rather than overflowing
+  uint8_t input[64 + sizeof(WS_GUID)];
+  size_t keyLen = strnlen(key, 64);
+  memcpy(input, key, keyLen);
+  memcpy(input + keyLen, WS_GUID, sizeof(WS_GUID) - 1);
+  
+  uint8_t digest[20];
+  sha1(input, keyLen + sizeof(WS_GUID) - 1, digest);
+  
+  static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  char* p = out;
+  for(int i = 0; i < 20; i += 3) {
+    uint32_t v = (uint32_t)digest[i] << 16;
+    if(i + 1 < 20) v |= (uint32_t)digest[i + 1] << 8;
+    if(i + 2 < 20) v |= digest[i + 2];
+    *p++ = b64[(v >> 18) & 63];
+    *p++ = b64[(v >> 12) & 63];
+    *p++ = i + 1 < 20 ? b64[(v >> 6) & 63] : '=';
+    *p++ = i + 2 < 20 ? b64[v & 63] : '=';
+  }
+  *p = 0;
+}
+
+size_t wsFrameHeader(uint8_t* out, uint8_t opcode, size_t len) {
+  out[0] = 0x80 | opcode;
+  if(len < 126) {
+    out[1] = len;
+    return 2;
+  }
+  if(len <= 0xFFFF) {
+    out[1] = 126;
+    out[2] = len >> 8;
+    out[3] = len;
+    return 4;
+  }
+  out[1] = 127;
+  for(int i = 0; i < 8; i++) out[9 - i] = (uint64_t)len >> (i * 8);
+  return 10;
+}
+
+bool wsParseHeader(const uint8_t* data, size_t len, WsFrameInfo& frame) {
+  if(len < 2 || !(data[1] & 0x80)) return false;
+  frame.final = data[0] & 0x80;
+  frame.opcode = data[0] & 0x0F;
+  
+  size_t pos = 2;
+  size_t payload = data[1] & 0x7F;
+  if(payload == 126) {
+    if(len < 4) return false;
+    payload = ((size_t)data[2] << 8) | data[3];
+    pos = 4;
+  } else if(payload == 127) {
+    if(len < 10) return false;
+    // Nothing a dashboard sends comes close; anything past 4 GB is refused
+    if(data[2] | data[3] | data[4] | data[5]) return false;
+    payload = ((size_t)data[6] << 24) | ((size_t)data[7] << 16) | ((size_t)data[8] << 8) | data[9];
+    pos = 10;
+  }
+  if(len < pos + 4) return false;
+  memcpy(frame.mask, data + pos, 4);
+  frame.headerLen = pos + 4;
+  frame.payloadLen = payload;
+  return true;
+}
+
+void wsUnmask(uint8_t* data, size_t len, const uint8_t* mask, size_t offset) {
+  for(size_t i = 0; i < len; i++) data[i] ^= mask[(offset + i) & 3];
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#define WS_OP_CONTINUATION 0x0
+#define WS_OP_TEXT 0x1
+#define WS_OP_BINARY 0x2
+#define WS_OP_CLOSE 0x8
+#define WS_OP_PING 0x9
+#define WS_OP_PONG 0xA
+
+#define WS_ACCEPT_LEN 28
+#define WS_HEADER_MAX 10
+
+// Just the RFC 6455 framing pieces the live feed needs; the transport is
+// whatever socket the caller already owns.
+
+// Sec-WebSocket-Accept for a client's Sec-WebSocket-Key, NUL-terminated
+// into `out` (at least WS_ACCEPT_LEN + 1 bytes)
+void wsAcceptKey(const char* key, char* out);
+
+// Writes an unmasked, final server frame header for a `len`-byte payload.
+// Returns the header length (at most WS_HEADER_MAX).
+size_t wsFrameHeader(uint8_t* out, uint8_t opcode, size_t len);
+
+struct WsFrameInfo {
+  uint8_t opcode;
+  bool final;
+  size_t headerLen;
+  size_t payloadLen;
+  uint8_t mask[4];
+};
+
+// Parses a client frame header from the first `len` bytes of `data`.
+// Returns false if more bytes are needed or the frame is not masked.
+bool wsParseHeader(const uint8_t* data, size_t len, WsFrameInfo& frame);
+
+// Unmasks `len` payload bytes starting `offset` bytes into the payload
+void wsUnmask(uint8_t* data, size_t len, const uint8_t* mask, size_t offset = 0);
+
+// SHA-1 of `len` bytes into `digest` (20 bytes)
+void sha1(const uint8_t* data, size_t len, uint8_t* digest);
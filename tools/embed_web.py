@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Builds the embedded web UI.
+
+Inlines web/style.css and web/app.js into web/index.html, minifies the
+result, gzips it and writes src/web_index.h with a constexpr byte array and
+a content-hash ETag. Runs automatically as a PlatformIO pre-build script and
+can also be run by hand from the repo root:
+    python3 tools/embed_web.py
+"""
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+try:
+    Import("env")  # noqa: F821 -- provided when run by PlatformIO
+    ROOT = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+WEB = os.path.join(ROOT, "web")
+OUTPUT = os.path.join(ROOT, "src", "web_index.h")
+
+
+def read(name):
+    with open(os.path.join(WEB, name), encoding="utf-8") as f:
+        return f.read()
+
+
+def minify_css(css):
+    css = re.sub(r"/\*.*?\*/", "", css, flags=re.S)
+    css = re.sub(r"\s+", " ", css)
+    css = re.sub(r"\s*([{};,>])\s*", r"\1", css)
+    css = re.sub(r":\s+", ":", css)
+    return css.replace(";}", "}").strip()
+
+
+# Conservative on purpose: line breaks are kept so automatic semicolon
+# insertion still applies, only indentation, blank lines and whole-line
+# comments go. Leading whitespace inside template literals is HTML markup.
+def minify_js(js):
+    lines = []
+    for line in js.splitlines():
+        line = line.strip()
+        if line and not line.startswith("//"):
+            lines.append(line)
+    return "\n".join(lines)
+
+
+def minify_html(html):
+    html = re.sub(r"<!--.*?-->", "", html, flags=re.S)
+    html = re.sub(r">\s+<", "><", html)
+    return re.sub(r"\n\s*", "\n", html).strip()
+
+
+def build_page():
+    html = minify_html(read("index.html"))
+    css = minify_css(read("style.css"))
+    js = minify_js(read("app.js"))
+    html = html.replace("<link rel='stylesheet' href='style.css'>", "<style>" + css + "</style>")
+    html = html.replace("<script src='app.js'></script>", "<script>\n" + js + "\n</script>")
+    return html.encode("utf-8")
+
+
+def main():
+    page = build_page()
+    # mtime=0 keeps the output identical for identical input
+    packed = gzip.compress(page, compresslevel=9, mtime=0)
+    etag = hashlib.sha256(packed).hexdigest()[:16]
+
+    # Leave the header alone when nothing changed so main.cpp is not rebuilt
+    marker = "// etag %s" % etag
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT) as f:
+            if marker in f.read(512):
+                return
+
+    lines = [
+        "// Generated by tools/embed_web.py from web/ -- do not edit",
+        marker,
+        "#pragma once",
+        "#include <stddef.h>",
+        "#include <stdint.h>",
+        "",
+        "constexpr char INDEX_HTML_ETAG[] = \"\\\"%s\\\"\";" % etag,
+        "",
+        "// Constant data stays in memory-mapped flash on the ESP32",
+        "constexpr uint8_t INDEX_HTML_GZ[] = {",
+    ]
+    for i in range(0, len(packed), 16):
+        lines.append("  " + ", ".join("0x%02x" % b for b in packed[i:i + 16]) + ",")
+    lines += [
+        "};",
+        "",
+        "constexpr size_t INDEX_HTML_GZ_LEN = sizeof(INDEX_HTML_GZ);",
+        "",
+    ]
+
+    with open(OUTPUT, "w") as f:
+        f.write("\n".join(lines))
+    sys.stdout.write("web_index.h: %d bytes minified -> %d gzipped, etag %s\n" % (len(page), len(packed), etag))
+
+
+main()
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""Writes bench/data/beacons.pcap, the seed corpus of bench/bench_ie_parser.
+
+A small classic pcap with radiotap link type (127), laid out the way a
+monitor-mode capture on Linux stores it: a radiotap header (some with TSFT,
+some with an FCS the flags announce) in front of each beacon or probe
+response. The frames are written here rather than captured, but follow
+what common APs send: a WPA2 home router with WMM and WPS, a WPA2/WPA3
+transition AP with HE and a vendor tail past the analyzer's 320-byte
+capture copy, enterprise, open, hidden, legacy WPA/WPA2, WPA3-only, OWE
+and a probe request the parser has to reject. Run from the repo root:
+    python3 tools/make_beacon_pcap.py
+"""
+import os
+import struct
+import zlib
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+OUT = os.path.join(ROOT, "bench", "data", "beacons.pcap")
+
+LINKTYPE_RADIOTAP = 127
+RATES = bytes([0x82, 0x84, 0x8B, 0x96, 0x0C, 0x12, 0x18, 0x24])
+OUI_IEEE = bytes([0x00, 0x0F, 0xAC])
+OUI_MS = bytes([0x00, 0x50, 0xF2])
+
+
+def ie(ident, body):
+    return bytes([ident, len(body)]) + body
+
+
+def suites(oui, types):
+    return struct.pack("<H", len(types)) + b"".join(oui + bytes([t]) for t in types)
+
+
+def rsn(pairwise, akms, caps=0):
+    return ie(48, struct.pack("<H", 1) + OUI_IEEE + bytes([pairwise[0]]) + suites(OUI_IEEE, pairwise)
+              + suites(OUI_IEEE, akms) + struct.pack("<H", caps))
+
+
+def wpa(pairwise, akms):
+    body = OUI_MS + bytes([1]) + struct.pack("<H", 1) + OUI_MS + bytes([pairwise[0]])
+    return ie(221, body + suites(OUI_MS, pairwise) + suites(OUI_MS, akms))
+
+
+def ht(primary):
+    return ie(45, bytes([0xEF, 0x01]) + bytes(24)) + ie(61, bytes([primary, 0x05]) + bytes(20))
+
+
+def vht():
+    return ie(191, struct.pack("<I", 0x338B79B2) + bytes(8)) + ie(192, bytes([1, 42, 0, 0xFC, 0xFF]))
+
+
+def he():
+    return ie(255, bytes([35]) + bytes(21)) + ie(255, bytes([36]) + bytes(6))
+
+
+WMM = ie(221, OUI_MS + bytes([2, 1, 1, 0x80, 0]) + bytes(16))
+
+
+def wps(name):
+    body = OUI_MS + bytes([4]) + b"\x10\x4a\x00\x01\x10\x10\x44\x00\x01\x02"
+    body += b"\x10\x11" + struct.pack(">H", len(name)) + name
+    return ie(221, body)
+
+
+def beacon(bssid, ssid, channel, privacy, ies, subtype=0x80, seq=0):
+    header = bytes([subtype, 0, 0, 0]) + b"\xff" * 6 + bssid + bssid + struct.pack("<H", seq << 4)
+    capability = 0x0421 | (0x0010 if privacy else 0)
+    fixed = struct.pack("<QHH", 0x1234567 * (seq + 1), 100, capability)
+    return header + fixed + ie(0, ssid) + ie(1, RATES) + ie(3, bytes([channel])) + b"".join(ies)
+
+
+def radiotap(channel, signal, tsft=False, fcs=False):
+    freq = 5000 + 5 * channel if channel > 14 else 2407 + 5 * channel
+    present = (1 << 1) | (1 << 2) | (1 << 3) | (1 << 5)
+    fields = b""
+    if tsft:
+        present |= 1 << 0
+        fields += struct.pack("<Q", 987654321)
+    fields += bytes([0x10 if fcs else 0, 12]) + struct.pack("<HH", freq, 0x00A0 if channel <= 14 else 0x0140)
+    fields += struct.pack("<b", signal)
+    return struct.pack("<BBHI", 0, 0, 8 + len(fields), present) + fields
+
+
+def mac(last):
+    return bytes([0x02, 0x11, 0x22, 0x33, 0x44, last])
+
+
+FRAMES = [
+    # (frame, channel, signal, tsft, fcs)
+    (beacon(mac(1), b"HomeRouter-5A2F", 6, True,
+            [ie(7, b"US\x20\x01\x0b\x1e"), ht(6), rsn([4], [2]), WMM, wps(b"HomeRouter")]), 6, -48, False, True),
+    (beacon(mac(2), b"Office", 36, True,
+            [ie(7, b"DE\x20\x24\x04\x17"), ht(36), vht(), he(), rsn([4], [2, 8], 0x0080), WMM,
+             wps(b"Office AP with a rather long device name"), ie(221, bytes([0x00, 0x10, 0x18, 2]) + bytes(60)),
+             ie(221, bytes([0x00, 0x0C, 0x43, 4]) + bytes(80)), ie(221, bytes([0x50, 0x6F, 0x9A, 0x16]) + bytes(40))]),
+     36, -61, True, True),
+    (beacon(mac(3), b"Corp-Secure", 11, True, [ie(7, b"GB\x20\x01\x0d\x14"), ht(11), rsn([4], [1]), WMM]),
+     11, -70, True, False),
+    (beacon(mac(4), b"Free Cafe WiFi", 1, False, [ht(1), WMM]), 1, -75, False, False),
+    (beacon(mac(5), b"", 6, True, [ht(6), rsn([4], [2])]), 6, -66, False, True),
+    (beacon(mac(6), bytes(8), 6, True, [ht(6), rsn([4], [2])]), 6, -67, False, False),
+    (beacon(mac(7), b"OldRouter", 3, True, [rsn([4, 2], [2]), wpa([2, 4], [2])]), 3, -80, False, False),
+    (beacon(mac(8), b"Modern", 149, True, [ie(7, b"DE\x20\x24\x04\x17"), ht(149), vht(), he(), rsn([4], [8], 0x00C0)],
+            subtype=0x50, seq=9), 149, -55, True, True),
+    (beacon(mac(9), b"OWE-Guest", 44, True, [vht(), rsn([4], [18], 0x00C0)]), 44, -58, False, False),
+    (bytes([0x40, 0, 0, 0]) + b"\xff" * 6 + mac(10) + b"\xff" * 6 + b"\x00\x00" + ie(0, b"") + ie(1, RATES),
+     6, -40, False, False),
+]
+
+
+def main():
+    records = b""
+    for i, (frame, channel, signal, tsft, fcs) in enumerate(FRAMES):
+        data = frame + (struct.pack("<I", zlib.crc32(frame)) if fcs else b"")
+        packet = radiotap(channel, signal, tsft, fcs) + data
+        records += struct.pack("<IIII", 1700000000 + i, 1000 * i, len(packet), len(packet)) + packet
+    os.makedirs(os.path.dirname(OUT), exist_ok=True)
+    with open(OUT, "wb") as f:
+        f.write(struct.pack("<IHHiIII", 0xA1B2C3D4, 2, 4, 0, 0, 65535, LINKTYPE_RADIOTAP) + records)
+    print("wrote %s (%d frames)" % (os.path.relpath(OUT, ROOT), len(FRAMES)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,314 @@
+let autoScan = false;
+let events;
+let live;
+let renderPending = false;
+let currentSort = 'rssi';
+let filterText = '';
+let scanBoot = '';
+let scanGen = 0;
+const networks = new Map();
+const byId = new Map();
+const cards = new Map();
+let channelBars;
+let lastStats = '';
+
+function scan() {
+  fetch('/scan?since=' + scanBoot + '-' + scanGen).then(r => r.json().then(data => {
+    data.age = parseInt(r.headers.get('X-Scan-Age'));
+    data.scanning = r.headers.get('X-Scanning') === '1';
+    return data;
+  })).then(data => {
+    if(data.age < 0) {
+      document.getElementById('networks').innerHTML = '<div class="loading"><div class="spinner"></div>Scanning networks...</div>';
+      setTimeout(scan, 1000);
+      return;
+    }
+    applyScan(data);
+  });
+}
+
+function applyScan(data) {
+  // A poll can land after a newer pushed event; applying it, full list or
+  // delta, would roll the table back. Generations restart when the device
+  // reboots, so from another boot only a full list is applied, and it
+  // replaces everything.
+  if(data.boot === scanBoot ? data.gen < scanGen : !data.full) return;
+  scanBoot = data.boot;
+  
+  // Removals first: a BSS can be removed and re-added within one delta
+  if(data.full) networks.clear();
+  (data.removed || []).forEach(b => networks.delete(b));
+  const now = Date.now();
+  data.networks.forEach(n => {
+    n.seenAt = now - data.age - n.last_seen;
+    networks.set(n.bssid, n);
+  });
+  scanGen = data.resync ? 0 : data.gen;
+  if(data.resync) scan();
+  
+  byId.clear();
+  networks.forEach(n => byId.set(n.id, n));
+  document.getElementById('scanAge').innerText = 'Updated ' + (data.age / 1000).toFixed(1) + 's ago' + (data.scanning ? ' (sweeping...)' : '');
+  scheduleRender();
+}
+
+const sorters = {
+  rssi: (a, b) => b.rssi - a.rssi,
+  channel: (a, b) => a.ch - b.ch || b.rssi - a.rssi,
+  ssid: (a, b) => a.ssid.localeCompare(b.ssid)
+};
+
+function render() {
+  const all = Array.from(networks.values());
+  const list = filterText ? all.filter(n => (n.ssid + ' ' + n.bssid).toLowerCase().includes(filterText)) : all;
+  // Ties keep a stable order so equal cards do not swap on every update
+  list.sort((a, b) => sorters[currentSort](a, b) || (a.bssid < b.bssid ? -1 : 1));
+  displayNetworks(all, list);
+  updateChannelGraph(all);
+}
+
+// Live samples can arrive far faster than the page can redraw; they only
+// update the model and the DOM catches up once per animation frame
+function scheduleRender() {
+  if(renderPending) return;
+  renderPending = true;
+  requestAnimationFrame(() => {
+    renderPending = false;
+    render();
+  });
+}
+
+// Binary live feed: a u32 device timestamp, then 6-byte little-endian
+// records of u16 id, i8 rssi, u8 channel, u16 sample age in ms
+function decodeLive(buf) {
+  const view = new DataView(buf);
+  const count = (buf.byteLength - 4) / 6 | 0;
+  const s = { id: new Uint16Array(count), rssi: new Int8Array(count), ch: new Uint8Array(count), age: new Uint16Array(count) };
+  for(let i = 0, o = 4; i < count; i++, o += 6) {
+    s.id[i] = view.getUint16(o, true);
+    s.rssi[i] = view.getInt8(o + 2);
+    s.ch[i] = view.getUint8(o + 3);
+    s.age[i] = view.getUint16(o + 4, true);
+  }
+  return s;
+}
+
+function applyLive(buf) {
+  const s = decodeLive(buf);
+  const now = Date.now();
+  for(let i = 0; i < s.id.length; i++) {
+    // Ids show up in a scan update before they are worth plotting
+    const n = byId.get(s.id[i]);
+    if(!n) continue;
+    n.rssi = s.rssi[i];
+    n.ch = s.ch[i];
+    n.seenAt = now - s.age[i];
+  }
+  scheduleRender();
+}
+
+// The device captures beacons for as long as the feed is open
+function toggleLive() {
+  const btn = document.getElementById('liveBtn');
+  if(live) {
+    live.close();
+    return;
+  }
+  btn.innerText = '⏹️ Stop Live';
+  live = new WebSocket('ws://' + location.host + '/live');
+  live.binaryType = 'arraybuffer';
+  live.onmessage = e => applyLive(e.data);
+  live.onclose = () => {
+    live = null;
+    btn.innerText = '📡 Live RSSI';
+  };
+}
+
+function signalQuality(rssi) {
+  return rssi >= -50 ? ['excellent', 'Excellent'] : rssi >= -60 ? ['good', 'Good'] : rssi >= -70 ? ['fair', 'Fair'] : rssi >= -80 ? ['weak', 'Weak'] : ['very-weak', 'Very Weak'];
+}
+
+const cardTemplate = document.createElement('template');
+cardTemplate.innerHTML = `
+  <div class='network-card'>
+    <div class='network-header'>
+      <div>
+        <span class='network-ssid'></span>
+        <span class='hidden-badge'>HIDDEN</span>
+      </div>
+      <span class='signal-badge'></span>
+    </div>
+    <div class='signal-bar'>
+      <div class='signal-fill'></div>
+    </div>
+    <div class='network-details'>
+      <div class='detail'><span class='detail-label'>Signal:</span> <span></span></div>
+      <div class='detail'><span class='detail-label'>Channel:</span> <span></span></div>
+      <div class='detail'><span class='detail-label'>Security:</span> <span></span></div>
+      <div class='detail'><span class='detail-label'>BSSID:</span> <span></span></div>
+      <div class='detail'><span class='detail-label'>Last Seen:</span> <span></span></div>
+    </div>
+  </div>`.trim();
+
+// Cards are built once per BSSID and keep references to the nodes they
+// update, plus the text last written to each, so a render only touches
+// nodes whose content actually changed
+function createCard() {
+  const el = cardTemplate.content.firstChild.cloneNode(true);
+  const values = el.querySelectorAll('.detail > span:last-child');
+  return {
+    el,
+    nodes: {
+      ssid: el.querySelector('.network-ssid'),
+      hidden: el.querySelector('.hidden-badge'),
+      badge: el.querySelector('.signal-badge'),
+      fill: el.querySelector('.signal-fill'),
+      rssi: values[0], ch: values[1], enc: values[2], bssid: values[3], seen: values[4]
+    },
+    shown: {}
+  };
+}
+
+function setText(card, field, text) {
+  if(card.shown[field] === text) return;
+  card.shown[field] = text;
+  card.nodes[field].textContent = text;
+}
+
+function updateCard(card, n, now) {
+  const [quality, qualityText] = signalQuality(n.rssi);
+  setText(card, 'ssid', n.ssid);
+  setText(card, 'badge', qualityText);
+  setText(card, 'rssi', n.rssi + ' dBm');
+  setText(card, 'ch', String(n.ch));
+  setText(card, 'enc', n.enc);
+  setText(card, 'bssid', n.bssid);
+  setText(card, 'seen', Math.round((now - n.seenAt) / 1000) + 's ago (' + n.seen_count + 'x)');
+  if(card.shown.hidden !== n.hidden) {
+    card.shown.hidden = n.hidden;
+    card.nodes.hidden.style.display = n.hidden ? '' : 'none';
+  }
+  if(card.shown.quality !== quality) {
+    card.shown.quality = quality;
+    card.nodes.badge.className = 'signal-badge signal-' + quality;
+  }
+  const percent = Math.max(0, Math.min(100, 2 * (n.rssi + 100)));
+  if(card.shown.percent !== percent) {
+    card.shown.percent = percent;
+    card.nodes.fill.style.width = percent + '%';
+  }
+}
+
+function displayNetworks(all, list) {
+  const stats = { total: all.length, open: 0, hidden: 0 };
+  all.forEach(n => {
+    if(n.enc === 'Open') stats.open++;
+    if(n.hidden) stats.hidden++;
+  });
+  const statsKey = stats.total + '/' + stats.open + '/' + stats.hidden;
+  if(statsKey !== lastStats) {
+    lastStats = statsKey;
+    document.getElementById('totalNetworks').innerText = stats.total;
+    document.getElementById('openNetworks').innerText = stats.open;
+    document.getElementById('hiddenNetworks').innerText = stats.hidden;
+  }
+  
+  const container = document.getElementById('networks');
+  if(cards.size === 0 && container.firstChild) container.textContent = '';
+  
+  // Drop cards for networks that are gone or filtered out
+  const visible = new Set(list.map(n => n.bssid));
+  cards.forEach((card, bssid) => {
+    if(!visible.has(bssid)) {
+      card.el.remove();
+      cards.delete(bssid);
+    }
+  });
+  
+  // Walk the wanted order against the current children and only move the
+  // cards that are out of place
+  const now = Date.now();
+  let cursor = container.firstChild;
+  list.forEach(n => {
+    let card = cards.get(n.bssid);
+    if(!card) {
+      card = createCard();
+      cards.set(n.bssid, card);
+    }
+    updateCard(card, n, now);
+    if(card.el === cursor) cursor = cursor.nextSibling;
+    else container.insertBefore(card.el, cursor);
+  });
+}
+
+// The 13 bars are created once; updates only change the bars whose count
+// or scale moved
+function updateChannelGraph(data) {
+  const graph = document.getElementById('channelGraph');
+  if(!channelBars) {
+    channelBars = [];
+    for(let ch = 1; ch <= 13; ch++) {
+      const bar = document.createElement('div');
+      bar.className = 'channel-bar';
+      const count = document.createElement('div');
+      count.className = 'channel-count';
+      const label = document.createElement('div');
+      label.className = 'channel-label';
+      label.textContent = 'Ch ' + ch;
+      bar.append(count, label);
+      graph.appendChild(bar);
+      channelBars.push({ bar, count, shown: -1, height: -1 });
+    }
+  }
+  
+  const counts = new Array(14).fill(0);
+  data.forEach(n => {
+    if(n.ch >= 1 && n.ch <= 13) counts[n.ch]++;
+  });
+  const maxCount = Math.max(...counts);
+  
+  for(let ch = 1; ch <= 13; ch++) {
+    const b = channelBars[ch - 1];
+    const height = maxCount > 0 ? (counts[ch] / maxCount) * 100 : 0;
+    if(b.height !== height) {
+      b.height = height;
+      b.bar.style.height = height + '%';
+    }
+    if(b.shown !== counts[ch]) {
+      b.shown = counts[ch];
+      b.bar.title = 'Channel ' + ch + ': ' + counts[ch] + ' networks';
+      b.count.textContent = counts[ch] > 0 ? counts[ch] : '';
+      b.count.style.display = counts[ch] > 0 ? '' : 'none';
+    }
+  }
+}
+
+function toggleAutoScan() {
+  autoScan = !autoScan;
+  const btn = document.getElementById('autoBtn');
+  if(autoScan) {
+    btn.innerText = '⏸️ Stop Auto';
+    events = new EventSource('/events');
+    events.addEventListener('scan', e => {
+      const data = JSON.parse(e.data);
+      data.age = 0;
+      applyScan(data);
+    });
+  } else {
+    btn.innerText = '▶️ Auto Scan';
+    events.close();
+  }
+}
+
+// Sorting and filtering work on the local model; no request is made
+function sortBy(type) {
+  currentSort = type;
+  scheduleRender();
+}
+
+function filterNetworks(text) {
+  filterText = text.trim().toLowerCase();
+  scheduleRender();
+}
+
+scan();